@@ -1,44 +1,41 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "pico/stdlib.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
 #include "hardware/i2c.h"
 #include "hardware/clocks.h"
 #include "lib/ssd1306.h"
+#include "lib/control.h"
+#include "lib/flame.h"
+#include "lib/pins.h"
+#include "lib/pwm_channel.h"
+#include "lib/vessel.h"
+#include "lib/safety.h"
+#ifdef U7T_DS18B20
+#include "lib/ds18b20.h"
+#include "lib/probe_map.h"
+#endif
+#ifdef U7T_BREWLOG
+#include "lib/brewlog.h"
+#endif
 #include "U7T_projeto.pio.h"
 
-// Definições de pinos
-#define BUZZER_PIN     21
-#define JOYSTICK_X     27
-#define JOYSTICK_Y     26
-#define JOYSTICK_BTN   22
-#define BTN_A          5
-#define BTN_B          6
-#define LED_R          13
-#define LED_G          11
-#define LED_B          12
 #define DEADZONE       200
-#define WS2812_PIN     7
 #define DEBOUNCE_TIME  50000 // 50 ms em microssegundos
-#define SERVO_PIN 15  // Pino para o servo motor
+#define NAV_THRESHOLD  1000  // Desvio do eixo X que troca a panela em foco
+#define CONTROL_TICK_MS 50   // Período fixo do tick de controle
+#define BEEP_MS 250          // Duração do bipe de etapa concluída
 
-// Definições de estados
-typedef enum {
-    MENU_INICIAL,
-    PARADA_PROTEICA,
-    BETA_AMILASE,
-    ALFA_AMILASE,
-    MASH_OUT
-} system_state_t;
-
-// Estrutura para estágios de brassagem
-typedef struct {
-    float temp_min;
-    float temp_max;
-    const char* nome;
-    uint32_t duration;
-} brassagem_stage_t;
+#define UI_OVERVIEW    0xFF  // Tela com todas as panelas
+#define SENSOR_MAX_AGE_MS 2000 // Leitura mais velha que isso é tratada como ausente
+
+#ifndef VESSEL_DEFAULT_MODE
+#define VESSEL_DEFAULT_MODE VESSEL_MODE_MANUAL
+#endif
+
+static const char* const MODE_NAMES[VESSEL_MODES] = {"Manual", "Preaquece", "Automatico"};
 
 static const brassagem_stage_t STAGES[] = {
     {50.0f, 55.0f, "Parada Proteica", 15},
@@ -48,18 +45,29 @@ static const brassagem_stage_t STAGES[] = {
 };
 #define NUM_STAGES (sizeof(STAGES) / sizeof(STAGES[0]))
 
+static const brassagem_stage_t HLT_STAGES[] = {
+    {74.0f, 78.0f, "Agua Lavagem", 60}
+};
+
+static const brassagem_stage_t BOIL_STAGES[] = {
+    {96.0f, 100.0f, "Fervura", 60}
+};
+
+static const recipe_t RECIPES[] = {
+    {"Mostura", STAGES, NUM_STAGES},
+    {"HLT", HLT_STAGES, 1},
+    {"Fervura", BOIL_STAGES, 1},
+};
+static const recipe_t* const VESSEL_RECIPES[] = {&RECIPES[0], &RECIPES[1], &RECIPES[2], &RECIPES[0]};
+static const uint VALVE_PINS[] = {SERVO_PIN, HLT_VALVE_PIN, BOIL_VALVE_PIN, SPARE_VALVE_PIN};
+
 // Variáveis globais
 static uint16_t x_center, y_center;
-static system_state_t current_state = MENU_INICIAL;
+static vessels_t vessels;
+static uint8_t ui_vessel = VESSEL_COUNT > 1 ? UI_OVERVIEW : 0; // Panela em foco
 static int menu_selection = 0;
-static uint8_t flame_frame = 0;
-static bool flame_active = false;
-static uint32_t timer_start = 0; // Para o temporizador de estágio
-static uint32_t total_time_start = 0; // Para o temporizador total
-static bool timer_active = false;
-static bool timer_finished = false;
-static float temperature = 0.0f;
-static bool display_needs_update = false;
+static bool nav_latched = false; // Eixo X precisa voltar ao centro entre trocas
+static bool mode_latched = false; // Idem para o eixo Y no menu
 
 // Variáveis para debounce
 static uint64_t last_debounce_time_a = 0;
@@ -68,14 +76,55 @@ static uint64_t last_debounce_time_joystick = 0; // Para o botão do joystick
 static bool last_state_a = true;
 static bool last_state_b = true;
 static bool last_state_joystick = true; // Pull-up, HIGH (1) é o estado inicial
-static float last_temperature = 0.0f; // Temperatura do ciclo anterior
 
-static const uint8_t flame_frames[4][5][5] = {
-    {{1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}},
-    {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 0, 0}},
-    {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}},
-    {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 0}, {0, 1, 0, 1, 0}}
-};
+// Canais PWM configurados uma única vez em main()
+static servo_t valves[VESSEL_COUNT];
+static pwm_channel_t led_r_pwm;
+static pwm_channel_t buzzer_pwm;
+
+#ifdef U7T_DS18B20
+static ds18b20_bus_t probes;
+static probe_map_t probe_map; // Sonda de cada panela pela ROM, gravada na flash
+#endif
+
+#ifdef U7T_BREWLOG
+static brewlog_t brewlog;
+#endif
+
+static safety_t safety; // Intertravamento na interrupção do timer
+
+// Apresentação no seu próprio ritmo: a tela só é redesenhada quando algo que
+// ela mostra muda, e a chama avança pelo relógio
+typedef enum {
+    SCREEN_NONE,
+    SCREEN_ALARM,
+    SCREEN_OVERVIEW,
+    SCREEN_MENU,
+    SCREEN_RUNNING,
+} screen_t;
+
+// Conteúdo da tela na resolução em que aparece (sem preenchimento, para o
+// memcmp). Os timers em segundos dão a atualização de 1 Hz nas telas que os
+// mostram; telas paradas não custam nem CPU nem barramento.
+typedef struct {
+    uint32_t stage_time;
+    uint32_t total_time;
+    uint32_t remaining_time;
+    uint32_t reaction_us;
+    int16_t temp10[VESSEL_MAX];   // Décimos de grau, como no "%.1f"
+    uint8_t status[VESSEL_MAX];   // VIEW_* de cada panela
+    uint8_t screen;
+    uint8_t vessel;
+    uint8_t selection;            // Estágio no menu ou em execução
+    uint8_t mode;                 // Modo no menu, motivo no alarme
+} view_t;
+
+#define VIEW_RUNNING    0x01
+#define VIEW_FLAME      0x02
+#define VIEW_PREHEATING 0x04
+
+static view_t shown_view = {.screen = SCREEN_NONE};
+static uint8_t shown_flame = 0xFF; // Quadro na matriz de LEDs (FLAME_FRAMES = apagada)
 
 // Função de debounce
 bool debounce_button(uint gpio, uint64_t now, bool* last_state, uint64_t* last_debounce_time) {
@@ -93,17 +142,6 @@ bool debounce_button(uint gpio, uint64_t now, bool* last_state, uint64_t* last_d
     return false;
 }
 
-// Funções de inicialização
-void pwm_init_gpio(uint gpio, uint32_t freq) {
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-    uint slice = pwm_gpio_to_slice_num(gpio);
-    uint32_t clock_freq = clock_get_hz(clk_sys);
-    uint32_t wrap_value = clock_freq / freq - 1;
-    pwm_set_wrap(slice, wrap_value);
-    pwm_set_clkdiv(slice, 1.0f);
-    pwm_set_enabled(slice, true);
-}
-
 int16_t adjust_value(int16_t raw, int16_t center) {
     int16_t diff = raw - center;
     if (abs(diff) < DEADZONE) return 0;
@@ -125,14 +163,28 @@ void calibrate_joystick() {
 
 // Controle de dispositivos
 void set_buzzer_position(uint16_t pulse) {
-    pwm_set_gpio_level(BUZZER_PIN, pulse);
+    pwm_channel_set_level(&buzzer_pwm, pulse);
 }
 
 void stop_buzzer() {
-    pwm_set_gpio_level(BUZZER_PIN, 0);
+    pwm_channel_set_level(&buzzer_pwm, 0);
 }
 
 // Funções de display
+//
+// As telas são desenhadas para 64 linhas, com a moldura dupla. Em painéis
+// de 32 linhas a moldura sai e as telas usam quatro linhas de texto de 8
+// pixels coladas: UI_ROW escolhe a linha de cada layout.
+#if DISPLAY_HEIGHT == 32
+#define UI_COMPACT 1
+#define UI_ROW(full, compact) (compact)
+#define UI_LEFT 0
+#else
+#define UI_COMPACT 0
+#define UI_ROW(full, compact) (full)
+#define UI_LEFT 5
+#endif
+
 void draw_hline(int x0, int x1, int y, bool color) {
     for (int x = x0; x <= x1; x++) ssd1306_draw_pixel(x, y, color);
 }
@@ -142,6 +194,7 @@ void draw_vline(int x, int y0, int y1, bool color) {
 }
 
 void draw_double_border() {
+    if (UI_COMPACT) return; // Não sobra linha para a moldura
     draw_hline(0, DISPLAY_WIDTH - 1, 0, true);
     draw_hline(0, DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1, true);
     draw_vline(0, 0, DISPLAY_HEIGHT - 1, true);
@@ -152,123 +205,182 @@ void draw_double_border() {
     draw_vline(DISPLAY_WIDTH - 3, 2, DISPLAY_HEIGHT - 3, true);
 }
 
-void show_menu(int selection) {
+void show_menu(const recipe_t* recipe, int selection, uint8_t mode) {
     ssd1306_clear();
     draw_double_border();
-    ssd1306_draw_string(5, 6, "Selecione:");
-    ssd1306_draw_string(5, 16, STAGES[selection].nome);
-    ssd1306_draw_string(16, 48, "A:Prox  B:Sel");
-    ssd1306_update();
+    char title_str[16];
+    snprintf(title_str, sizeof(title_str), "%s:", recipe->nome);
+    ssd1306_draw_string(UI_LEFT, UI_ROW(6, 0), title_str);
+    ssd1306_draw_string(UI_LEFT, UI_ROW(16, 8), recipe->stages[selection].nome);
+    char mode_str[20];
+    snprintf(mode_str, sizeof(mode_str), "Y:%s", MODE_NAMES[mode]);
+    ssd1306_draw_string(UI_LEFT, UI_ROW(30, 16), mode_str);
+    ssd1306_draw_string(UI_COMPACT ? 0 : 16, UI_ROW(48, 24), "A:Prox  B:Sel");
 }
 
-void update_display(float temperature, const brassagem_stage_t* stage, bool flame_active, uint32_t stage_time, uint32_t total_time) {
+void update_display(float temperature, const brassagem_stage_t* stage, bool flame_active, uint32_t stage_time, uint32_t total_time,
+                    uint32_t remaining_time, bool preheating) {
     ssd1306_clear();
     draw_double_border();
-    char temp_str[16];
+    ssd1306_draw_string(UI_LEFT, UI_ROW(6, 0), stage->nome);
+    char temp_str[20];
+#if UI_COMPACT
+    // Temperatura e chama dividem a linha
+    snprintf(temp_str, sizeof(temp_str), "T:%.1f %s%s", temperature, flame_active ? "ON" : "OFF",
+             preheating ? " >>" : "");
+    ssd1306_draw_string(0, 8, temp_str);
+#else
     snprintf(temp_str, sizeof(temp_str), "T: %.1f°C", temperature);
-    ssd1306_draw_string(5, 6, stage->nome);
-    ssd1306_draw_string(22, 20, temp_str);
+    ssd1306_draw_string(22, 16, temp_str);
+#endif
+    char remaining_str[20];
+    snprintf(remaining_str, sizeof(remaining_str), "Fim em %lum%02lus", remaining_time / 60, remaining_time % 60);
+    ssd1306_draw_string(UI_LEFT, UI_ROW(27, 24), remaining_str);
     char stage_timer_str[16];
     snprintf(stage_timer_str, sizeof(stage_timer_str), "Ti: %lus", stage_time);
-    ssd1306_draw_string(5, 38, stage_timer_str);
+    ssd1306_draw_string(UI_LEFT, UI_ROW(38, 16), stage_timer_str);
     char total_timer_str[16];
     snprintf(total_timer_str, sizeof(total_timer_str), "Tt: %lus", total_time);
-    ssd1306_draw_string(64, 38, total_timer_str);
+    ssd1306_draw_string(64, UI_ROW(38, 16), total_timer_str);
+#if !UI_COMPACT
     char flame_str[16];
-    snprintf(flame_str, sizeof(flame_str), "Chama: %s", flame_active ? "ON" : "OFF");
+    snprintf(flame_str, sizeof(flame_str), "Chama: %s%s", flame_active ? "ON" : "OFF", preheating ? " >>" : "");
     ssd1306_draw_string(5, 48, flame_str);
-    ssd1306_update();
+#endif
 }
 
-// Funções do servo motor
-void servo_init(uint gpio) {
-    gpio_set_function(gpio, GPIO_FUNC_PWM);
-    uint slice = pwm_gpio_to_slice_num(gpio);
-    uint32_t clock_freq = clock_get_hz(clk_sys);
-    uint32_t wrap_value = clock_freq / 50 - 1;
-    pwm_set_wrap(slice, wrap_value);
-    pwm_set_clkdiv(slice, 1.0f);
-    pwm_set_enabled(slice, true);
+// Visão geral multiplexada: uma linha por panela
+void show_overview(const vessels_t* v) {
+    ssd1306_clear();
+    draw_double_border();
+    for (uint8_t i = 0; i < v->count; i++) {
+        char line[16];
+        const char* status = !vessel_running(v, i) ? "---" : v->flame_active[i] ? "ON" : "OFF";
+        snprintf(line, sizeof(line), "%-4.4s %5.1f %s", v->recipe[i]->nome, v->temperature[i], status);
+        ssd1306_draw_string(UI_LEFT, UI_ROW(6 + 12 * i, 8 * i), line);
+    }
 }
 
-void set_servo_angle(uint gpio, uint8_t angle) {
-    if (angle > 180) angle = 180;
-    uint slice = pwm_gpio_to_slice_num(gpio);
-    uint32_t wrap_value = clock_get_hz(clk_sys) / 50 - 1;
-    uint16_t level = (wrap_value * (1000 + (angle * 1000 / 180))) / 20000;
-    pwm_set_gpio_level(gpio, level);
+// Alarme do intertravamento: motivo, panela e pior caso de reação medido
+void show_alarm(const safety_t* s, const vessels_t* v) {
+    ssd1306_clear();
+    draw_double_border();
+    char line[20];
+#if UI_COMPACT
+    // O pior caso de reação vai no título
+    snprintf(line, sizeof(line), "ALARME %luus", safety_worst_case_us(s));
+    ssd1306_draw_string(0, 0, line);
+#else
+    ssd1306_draw_string(40, 6, "ALARME!");
+#endif
+    ssd1306_draw_string(UI_LEFT, UI_ROW(18, 8), safety_reason_name(s->reason));
+    if (s->reason != SAFETY_LOOP_STALL && s->reason != SAFETY_REBOOT) {
+        snprintf(line, sizeof(line), "Panela: %s", v->recipe[s->trip_vessel]->nome);
+        ssd1306_draw_string(UI_LEFT, UI_ROW(28, 16), line);
+    }
+#if !UI_COMPACT
+    snprintf(line, sizeof(line), "Reacao: %luus", safety_worst_case_us(s));
+    ssd1306_draw_string(5, 38, line);
+#endif
+    ssd1306_draw_string(UI_LEFT, UI_ROW(48, 24), "Joy: rearmar");
 }
 
-// Controle de temperatura
-void control_stage(float* temperature, const brassagem_stage_t* stage, uint8_t* servo_angle) {
-    adc_select_input(1); // JOYSTICK_Y
-    uint16_t raw_y = adc_read();
-    int16_t y_adjust = adjust_value(raw_y, y_center);
+// Leitura do joystick com zona morta
+int16_t read_joystick_axis(uint input, uint16_t center) {
+    adc_select_input(input);
+    return adjust_value(adc_read(), center);
+}
 
-    // Ajusta a temperatura com base no movimento do joystick
-    *temperature += ((float)y_adjust / 4095.0f) * 0.5f;
+// Animação da chama
+void update_flame_animation(PIO pio, uint sm, uint8_t frame, uint8_t servo_angle) {
+    uint32_t pixels[FLAME_PIXELS];
+    flame_encode_frame(pixels, frame, servo_angle);
+    for (int i = 0; i < FLAME_PIXELS; i++) {
+        pio_sm_put_blocking(pio, sm, pixels[i]);
+    }
+}
+// Décimos de grau arredondados sem lroundf(), que fica na flash
+static inline int16_t temp_tenths(float t) {
+    return (int16_t)(t * 10.0f + (t < 0.0f ? -0.5f : 0.5f));
+}
 
-    if (*temperature < 0.0f) *temperature = 0.0f;
-    if (*temperature > stage->temp_max) *temperature = stage->temp_max;
+// Temperatura e estado de uma panela, como a tela os mostra
+static void view_vessel(view_t* view, uint8_t i) {
+    view->temp10[i] = temp_tenths(vessels.temperature[i]);
+    view->status[i] = (vessel_running(&vessels, i) ? VIEW_RUNNING : 0) |
+                      (vessels.flame_active[i] ? VIEW_FLAME : 0) |
+                      (vessels.preheating[i] ? VIEW_PREHEATING : 0);
+}
 
-    // Verifica se a temperatura caiu em relação ao ciclo anterior
-    if (*temperature < last_temperature) {
-        flame_active = true;
-    } else if (*temperature >= stage->temp_max) {
-        flame_active = false;
+// Captura o que a tela atual mostraria agora. Só entram as panelas que a
+// tela exibe: todas na visão geral, a focada em execução e nenhuma no menu
+// e no alarme, para que as outras não provoquem redesenhos.
+void build_view(view_t* view, bool tripped, bool focused, uint32_t now_s) {
+    memset(view, 0, sizeof(*view));
+    if (tripped) {
+        view->screen = SCREEN_ALARM;
+        view->vessel = safety.trip_vessel;
+        view->mode = safety.reason;
+        view->reaction_us = safety_worst_case_us(&safety);
+    } else if (!focused) {
+        view->screen = SCREEN_OVERVIEW;
+        for (uint8_t i = 0; i < vessels.count; i++) view_vessel(view, i);
+    } else if (!vessel_running(&vessels, ui_vessel)) {
+        view->screen = SCREEN_MENU;
+        view->vessel = ui_vessel;
+        view->selection = menu_selection;
+        view->mode = vessels.mode[ui_vessel];
+    } else {
+        view->screen = SCREEN_RUNNING;
+        view->vessel = ui_vessel;
+        view->stage_time = vessel_stage_time(&vessels, ui_vessel, now_s);
+        view->total_time = vessel_total_time(&vessels, ui_vessel, now_s);
+        view->remaining_time = vessel_remaining_time(&vessels, ui_vessel, now_s);
+        view->selection = vessels.stage[ui_vessel];
+        view_vessel(view, ui_vessel);
     }
+}
 
-    // Controle proporcional da chama
-    float temp_range = stage->temp_max - stage->temp_min;
-    float temp_progress = (*temperature - stage->temp_min) / temp_range;
-    if (temp_progress < 0) temp_progress = 0;
-    if (temp_progress > 1) temp_progress = 1;
-
-    if (flame_active) {
-        *servo_angle = (uint8_t)(90 * (1 - temp_progress));
-        set_servo_angle(SERVO_PIN, *servo_angle);
-        uint16_t led_intensity = (uint16_t)(4095 * (1 - temp_progress));
-        pwm_set_gpio_level(LED_R, led_intensity);
-        *temperature += 0.1f; // Aumenta a temperatura enquanto a chama está ativa
-    } else {
-        *servo_angle = 0;
-        set_servo_angle(SERVO_PIN, *servo_angle);
-        pwm_set_gpio_level(LED_R, 0);
+// Redesenha a tela só quando o conteúdo mudou; o envio fica para a folga do
+// tick (ssd1306_service)
+void render_view(const view_t* view) {
+    if (memcmp(view, &shown_view, sizeof(*view)) == 0) return;
+    shown_view = *view;
+
+    uint8_t i = view->vessel;
+    switch (view->screen) {
+    case SCREEN_ALARM:
+        show_alarm(&safety, &vessels);
+        break;
+    case SCREEN_OVERVIEW:
+        show_overview(&vessels);
+        break;
+    case SCREEN_MENU:
+        show_menu(vessels.recipe[i], view->selection, view->mode);
+        break;
+    default:
+        update_display(vessels.temperature[i], vessel_current_stage(&vessels, i), vessels.flame_active[i],
+                       view->stage_time, view->total_time, view->remaining_time, vessels.preheating[i]);
+        break;
     }
 
-    // Atualiza a temperatura anterior para o próximo ciclo
-    last_temperature = *temperature;
+    ssd1306_request_update();
 }
 
-// Animação da chama
-void update_flame_animation(PIO pio, uint sm, uint8_t frame, uint8_t servo_angle) {
-    static const uint8_t flame_frames[4][5][5] = {
-        {{1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}},
-        {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 0, 0}},
-        {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}},
-        {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 0}, {0, 1, 0, 1, 0}}
-    };
-
-    float brightness = (float)servo_angle / 90.0f;
-    if (brightness < 0.0f) brightness = 0.0f;
-    if (brightness > 1.0f) brightness = 1.0f;
-
-    for (int y = 0; y < 5; y++) {
-        for (int x = 0; x < 5; x++) {
-            uint8_t intensity = flame_frames[frame][y][x];
-            uint8_t r = (intensity == 1) ? 64 : (intensity >= 2) ? 255 : 0;
-            uint8_t g = (intensity == 2) ? 64 : (intensity == 3) ? 128 : 0;
-            uint8_t b = 0;
-
-            r = (uint8_t)(r * brightness);
-            g = (uint8_t)(g * brightness);
-            b = (uint8_t)(b * brightness);
-
-            uint32_t grb = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
-            pio_sm_put_blocking(pio, sm, grb << 8u);
-        }
+// Matriz de LEDs: o quadro da chama vem do relógio e só é enviado quando
+// troca (o brilho acompanha a válvula a cada quadro)
+void render_flame(PIO pio, uint sm, bool active, uint8_t servo_angle, uint32_t now_ms) {
+    uint8_t frame = active ? (now_ms / FLAME_FRAME_MS) % FLAME_FRAMES : FLAME_FRAMES;
+    if (frame == shown_flame) return;
+    shown_flame = frame;
+
+    if (active) {
+        update_flame_animation(pio, sm, frame, servo_angle);
+    } else {
+        for (int i = 0; i < FLAME_PIXELS; i++) pio_sm_put_blocking(pio, sm, 0 << 8u);
     }
 }
+
 void show_tela_inicial() {
     ssd1306_clear();
     draw_double_border(); // Reutiliza a borda dupla que você já tem
@@ -276,8 +388,8 @@ void show_tela_inicial() {
     // "EMBARCATECH" tem 10 caracteres. Cada caractere é 5 pixels de largura + 1 de espaço = 6 pixels por caractere
     // Total: 10 * 6 = 60 pixels de largura
     // Centralizar horizontalmente: (128 - 60) / 2 = 34
-    // Centralizar verticalmente: (64 - 8) / 2 = 28 (assumindo altura de fonte de 8 pixels)
-    ssd1306_draw_string(20, 28, "EMBARCATECH");
+    // Centralizar verticalmente: (64 - 8) / 2 = 28 (assumindo altura de fonte de 8 pixels; 12 em 32 linhas)
+    ssd1306_draw_string(20, UI_ROW(28, 12), "EMBARCATECH");
 
     ssd1306_update();
     sleep_ms(3000); // Mostra a tela por 3 segundos
@@ -294,17 +406,20 @@ int main() {
     gpio_init(BTN_A);        gpio_set_dir(BTN_A, GPIO_IN);        gpio_pull_up(BTN_A);
     gpio_init(BTN_B);        gpio_set_dir(BTN_B, GPIO_IN);        gpio_pull_up(BTN_B);
 
-    pwm_init_gpio(LED_R, 50);
+    pwm_channel_init(&led_r_pwm, LED_R, 50);
     gpio_init(LED_G); gpio_set_dir(LED_G, GPIO_OUT); gpio_put(LED_G, false);
     gpio_init(LED_B); gpio_set_dir(LED_B, GPIO_OUT); gpio_put(LED_B, false);
 
-    pwm_init_gpio(BUZZER_PIN, 500);
-    uint32_t wrap_value = clock_get_hz(clk_sys) / 500 - 1;
-    uint16_t pulse_max = wrap_value * 0.1;
+    pwm_channel_init(&buzzer_pwm, BUZZER_PIN, 500);
+    uint16_t pulse_max = buzzer_pwm.wrap / 10; // 10% de duty
     stop_buzzer();
 
-    servo_init(SERVO_PIN);
-    set_servo_angle(SERVO_PIN, 0);
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+        servo_init(&valves[i], VALVE_PINS[i]);
+        servo_set_angle(&valves[i], 0);
+    }
+    vessels_init(&vessels, VESSEL_RECIPES, VESSEL_COUNT);
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) vessels.mode[i] = VESSEL_DEFAULT_MODE;
 
     ssd1306_init();
     show_tela_inicial();
@@ -312,157 +427,197 @@ int main() {
     PIO pio = pio0;
     uint sm = 0;
     uint offset = pio_add_program(pio, &U7T_projeto_program);
+    pio_sm_claim(pio, sm); // SM0 fica com os LEDs; o 1-Wire pega a próxima livre
     U7T_projeto_program_init(pio, sm, offset, WS2812_PIN, 800000, false);
 
+#ifdef U7T_DS18B20
+    ds18b20_init(&probes, pio, ONEWIRE_PIN);
+    probe_map_init(&probe_map);
+    // Sem leitura até a primeira busca associar as sondas
+    for (uint8_t i = 0; i < VESSEL_COUNT; i++) vessels.sensor[i] = DS18B20_NO_PROBE;
+#endif
+
     calibrate_joystick();
 
+#ifdef U7T_BREWLOG
+    brewlog_init(&brewlog);
+#endif
+
+    // Por último: a partir daqui o laço precisa dar sinal de vida a cada tick
+#ifdef U7T_DS18B20
+    safety_init(&safety, valves, VESSEL_COUNT, &buzzer_pwm, pulse_max, vessels.sensor, &probes);
+#else
+    safety_init(&safety, valves, VESSEL_COUNT, &buzzer_pwm, pulse_max, vessels.sensor);
+#endif
+
     uint32_t last_blink_time = 0;
     bool led_state = false;
-    bool first_max_reached = false;
-    uint8_t servo_angle = 0;
+    bool beeping = false;
+    absolute_time_t beep_until = nil_time;
+    absolute_time_t next_tick = get_absolute_time();
 
     while (true) {
         uint32_t current_time = time_us_32() / 1000000;
         uint64_t now = time_us_64();
-
-        uint32_t stage_time = timer_active ? (current_time - timer_start) : 0;
-        uint32_t total_time = (current_state != MENU_INICIAL && total_time_start != 0) ? (current_time - total_time_start) : 0;
+        bool focused = ui_vessel != UI_OVERVIEW;
 
         bool btn_a_pressed = debounce_button(BTN_A, now, &last_state_a, &last_debounce_time_a);
         bool btn_b_pressed = debounce_button(BTN_B, now, &last_state_b, &last_debounce_time_b);
         bool btn_joystick_pressed = debounce_button(JOYSTICK_BTN, now, &last_state_joystick, &last_debounce_time_joystick);
 
+        // Eixo X alterna: visão geral -> panela 0 -> panela 1 -> ... -> visão geral
+        if (VESSEL_COUNT > 1) {
+            int16_t x_adjust = read_joystick_axis(0, x_center); // JOYSTICK_X
+            if (!nav_latched && abs(x_adjust) > NAV_THRESHOLD) {
+                int step = x_adjust > 0 ? 1 : VESSEL_COUNT;
+                int pos = (ui_vessel == UI_OVERVIEW) ? VESSEL_COUNT : ui_vessel;
+                pos = (pos + step) % (VESSEL_COUNT + 1);
+                ui_vessel = (pos == VESSEL_COUNT) ? UI_OVERVIEW : (uint8_t)pos;
+                focused = ui_vessel != UI_OVERVIEW;
+                menu_selection = 0;
+                nav_latched = true;
+            } else if (x_adjust == 0) {
+                nav_latched = false;
+            }
+        }
+
         if (btn_joystick_pressed) {
-            current_state = MENU_INICIAL;
+            if (safety_tripped(&safety)) {
+                safety_reset(&safety);
+            } else if (focused) {
+                vessel_reset(&vessels, ui_vessel);
+            } else {
+                for (uint8_t i = 0; i < VESSEL_COUNT; i++) vessel_reset(&vessels, i);
+            }
             menu_selection = 0;
-            flame_active = false;
-            timer_active = false;
-            timer_finished = false;
-            first_max_reached = false;
-            temperature = 0.0f;
-            last_temperature = 0.0f; // Reseta a temperatura anterior
-            timer_start = 0;
-            total_time_start = 0;
-            pwm_set_gpio_level(LED_R, 0);
             gpio_put(LED_G, false);
             gpio_put(LED_B, false);
-            set_servo_angle(SERVO_PIN, 0);
-            servo_angle = 0;
             stop_buzzer();
         }
 
-        if (btn_a_pressed) {
-            if (current_state == MENU_INICIAL) {
-                menu_selection = (menu_selection + 1) % NUM_STAGES;
-            } else if (timer_finished) {
-                if (current_state == MASH_OUT) {
-                    current_state = MENU_INICIAL;
-                    menu_selection = 0;
-                    total_time_start = 0;
-                } else {
-                    current_state = (system_state_t)(current_state + 1);
-                    temperature = STAGES[current_state - PARADA_PROTEICA].temp_min;
-                    last_temperature = temperature; // Inicializa a temperatura anterior
-                    timer_active = false;
-                    timer_finished = false;
-                    flame_active = true;
-                    first_max_reached = false;
-                }
+        if (btn_a_pressed && focused) {
+            if (!vessel_running(&vessels, ui_vessel)) {
+                menu_selection = (menu_selection + 1) % vessels.recipe[ui_vessel]->num_stages;
+            } else if (vessels.timer_finished[ui_vessel]) {
+                vessel_advance(&vessels, ui_vessel, current_time);
+                if (!vessel_running(&vessels, ui_vessel)) menu_selection = 0;
                 gpio_put(LED_G, false);
                 gpio_put(LED_B, false);
-                set_servo_angle(SERVO_PIN, 90);
-                servo_angle = 90;
                 stop_buzzer();
             }
         }
 
-        if (btn_b_pressed) {
-            if (current_state == MENU_INICIAL) {
-                current_state = (system_state_t)(PARADA_PROTEICA + menu_selection);
-                temperature = STAGES[menu_selection].temp_min;
-                last_temperature = temperature; // Inicializa a temperatura anterior
-                timer_active = false;
-                timer_finished = false;
-                flame_active = true;
-                first_max_reached = false;
-                set_servo_angle(SERVO_PIN, 90);
-                servo_angle = 90;
-                if (total_time_start == 0) total_time_start = current_time;
+        if (btn_b_pressed && focused) {
+            if (!vessel_running(&vessels, ui_vessel)) {
+                vessel_start(&vessels, ui_vessel, menu_selection, current_time);
             } else {
-                current_state = MENU_INICIAL;
-                flame_active = false;
-                timer_active = false;
-                timer_finished = false;
-                pwm_set_gpio_level(LED_R, 0);
+                vessel_stop(&vessels, ui_vessel);
                 gpio_put(LED_G, false);
                 gpio_put(LED_B, false);
-                set_servo_angle(SERVO_PIN, 0);
-                servo_angle = 0;
                 stop_buzzer();
             }
         }
 
-        switch (current_state) {
-            case MENU_INICIAL:
-                show_menu(menu_selection);
-                timer_active = false;
-                timer_finished = false;
-                flame_active = false;
-                first_max_reached = false;
-                gpio_put(LED_G, false);
-                gpio_put(LED_B, false);
-                set_servo_angle(SERVO_PIN, 0);
-                servo_angle = 0;
-                stop_buzzer();
-                break;
-
-            case PARADA_PROTEICA:
-            case BETA_AMILASE:
-            case ALFA_AMILASE:
-            case MASH_OUT: {
-                const brassagem_stage_t* stage = &STAGES[current_state - PARADA_PROTEICA];
-
-                control_stage(&temperature, stage, &servo_angle);
+        // O joystick (eixo Y) só atua na panela em foco: ajusta a temperatura
+        // simulada em execução e escolhe o modo de transição no menu
+        int16_t input[VESSEL_MAX] = {0};
+        if (focused && vessel_running(&vessels, ui_vessel)) {
+            input[ui_vessel] = read_joystick_axis(1, y_center); // JOYSTICK_Y
+        } else if (focused) {
+            int16_t y_adjust = read_joystick_axis(1, y_center);
+            if (!mode_latched && abs(y_adjust) > NAV_THRESHOLD) {
+                uint8_t step = y_adjust > 0 ? 1 : VESSEL_MODES - 1;
+                vessels.mode[ui_vessel] = (vessels.mode[ui_vessel] + step) % VESSEL_MODES;
+                mode_latched = true;
+            } else if (y_adjust == 0) {
+                mode_latched = false;
+            }
+        }
 
-                if (!first_max_reached && temperature >= stage->temp_max) {
-                    timer_start = current_time;
-                    timer_active = true;
-                    first_max_reached = true;
-                    gpio_put(LED_B, false);
-                }
+#ifdef U7T_DS18B20
+        // Só consulta a última leitura publicada; o barramento roda em segundo plano
+        uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+        probe_map_update(&probe_map, &probes, vessels.sensor, VESSEL_COUNT);
+        for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+            vessels.measured_ok[i] = ds18b20_read(&probes, vessels.sensor[i], now_ms,
+                                                  SENSOR_MAX_AGE_MS, &vessels.measured[i]);
+        }
+#endif
 
-                if (timer_active && stage_time >= stage->duration) {
-                    timer_finished = true;
-                    gpio_put(LED_B, false);
-                }
+        vessels_tick(&vessels, input, current_time);
 
-                update_display(temperature, stage, flame_active, stage_time, total_time);
-
-                if (timer_finished) {
-                    if ((current_time - last_blink_time) >= 1) {
-                        led_state = !led_state;
-                        gpio_put(LED_G, led_state);
-                        if (led_state) {
-                            set_buzzer_position(pulse_max);
-                            sleep_ms(250);
-                            stop_buzzer();
-                        }
-                        last_blink_time = current_time;
-                    }
+        // Intertravamento desarmado: válvulas fechadas até o operador rearmar
+        bool tripped = safety_tripped(&safety);
+        if (tripped) {
+            for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+                vessels.servo_angle[i] = 0;
+                vessels.flame_active[i] = false;
+            }
+        }
+        safety_publish(&safety, &vessels);
+#ifdef U7T_BREWLOG
+        brewlog_tick(&brewlog, &vessels, to_ms_since_boot(get_absolute_time()));
+#endif
+
+        // Saídas: uma válvula por panela; LED vermelho e chama seguem a panela
+        // em foco ou, na visão geral, a de maior abertura de válvula
+        uint8_t shown = focused ? ui_vessel : 0;
+        bool any_finished = false;
+        for (uint8_t i = 0; i < VESSEL_COUNT; i++) {
+            safety_set_valve(&safety, i, vessels.servo_angle[i]);
+#ifdef U7T_DS18B20_SIM
+            ds18b20_sim_set_heat(&probes, vessels.sensor[i], vessels.servo_angle[i]);
+#endif
+            if (!focused && vessels.servo_angle[i] > vessels.servo_angle[shown]) shown = i;
+            any_finished |= vessels.timer_finished[i];
+        }
+        pwm_channel_set_duty12(&led_r_pwm, vessels.led_intensity[shown]);
+
+        view_t view;
+        build_view(&view, tripped, focused, current_time);
+        render_view(&view);
+
+        if (any_finished && !tripped) {
+            if ((current_time - last_blink_time) >= 1) {
+                led_state = !led_state;
+                gpio_put(LED_G, led_state);
+                if (led_state) {
+                    // O tick desliga o bipe; o laço não para esperando
+                    set_buzzer_position(pulse_max);
+                    beep_until = make_timeout_time_ms(BEEP_MS);
+                    beeping = true;
                 }
-                break;
+                last_blink_time = current_time;
             }
+        } else if (led_state) {
+            led_state = false;
+            gpio_put(LED_G, false);
         }
 
-        if (flame_active) {
-            update_flame_animation(pio, sm, flame_frame, servo_angle);
-            flame_frame = (flame_frame + 1) % 4;
-        } else {
-            for (int i = 0; i < 25; i++) pio_sm_put_blocking(pio, sm, 0 << 8u);
+        // Desarmado, o buzzer é do alarme do intertravamento
+        if (beeping && (tripped || time_reached(beep_until))) {
+            if (!tripped) stop_buzzer();
+            beeping = false;
         }
 
-        sleep_ms(50);
+        render_flame(pio, sm, vessels.flame_active[shown], vessels.servo_angle[shown],
+                     to_ms_since_boot(get_absolute_time()));
+
+        // Tick de período fixo: o atraso do laço não acumula
+        next_tick = delayed_by_ms(next_tick, CONTROL_TICK_MS);
+#ifdef U7T_DS18B20
+        probe_map_service(&probe_map, &vessels, next_tick);
+#endif
+        // As páginas do display vão enquanto couberem antes do próximo tick;
+        // o resto do quadro segue nos ticks seguintes
+        ssd1306_service(next_tick);
+#ifdef U7T_BREWLOG
+        // Flash e exportação só usam a folga até o próximo tick
+        brewlog_poll_command(&brewlog);
+        brewlog_service(&brewlog, next_tick);
+#endif
+        sleep_until(next_tick);
     }
 
     return 0;
-}
\ No newline at end of file
+}
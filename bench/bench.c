@@ -0,0 +1,203 @@
+#include "bench.h"
+#include <string.h>
+#include "lib/ssd1306.h"
+#include "lib/control.h"
+#include "lib/flame.h"
+#include "lib/vessel.h"
+
+// Evita que o compilador descarte o resultado dos kernels
+volatile uint32_t bench_sink;
+
+static const brassagem_stage_t bench_stage = {50.0f, 55.0f, "Parada Proteica", 15};
+
+static void run_draw_string(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; i++) {
+        ssd1306_draw_string(5, 6, bench_stage.nome);
+    }
+}
+
+static void run_update(uint32_t iters) {
+    for (uint32_t i = 0; i < iters; i++) {
+        ssd1306_update();
+    }
+}
+
+static void run_flame_encode(uint32_t iters) {
+    uint32_t pixels[FLAME_PIXELS];
+    for (uint32_t i = 0; i < iters; i++) {
+        flame_encode_frame(pixels, (uint8_t)(i % FLAME_FRAMES), (uint8_t)(i % 91));
+        bench_sink += pixels[i % FLAME_PIXELS];
+    }
+}
+
+static void run_control_step(uint32_t iters) {
+    float temperature = bench_stage.temp_min;
+    float last_temperature = temperature;
+    bool flame_active = true;
+    uint16_t led;
+    for (uint32_t i = 0; i < iters; i++) {
+        // Alterna subida e descida para exercitar os dois ramos da chama
+        int16_t y_adjust = (i & 16) ? -800 : 300;
+        bench_sink += control_step(&temperature, &last_temperature, &flame_active,
+                                   &bench_stage, y_adjust, &led);
+        bench_sink += led;
+    }
+}
+
+static const recipe_t bench_recipe = {"Bench", &bench_stage, 1};
+
+// Executa N panelas; cada operação é um passo de uma panela, então o custo
+// por operação deve ficar constante quando N cresce.
+static void run_vessels_tick(uint8_t count, uint32_t iters) {
+    static vessels_t v;
+    const recipe_t* recipes[VESSEL_MAX] = {&bench_recipe, &bench_recipe, &bench_recipe, &bench_recipe};
+    int16_t input[VESSEL_MAX] = {0};
+    vessels_init(&v, recipes, count);
+    for (uint8_t i = 0; i < count; i++) vessel_start(&v, i, 0, 1);
+    for (uint32_t t = 0; t < iters / count; t++) {
+        input[0] = (t & 16) ? -800 : 300;
+        vessels_tick(&v, input, 1 + t / 20);
+    }
+    bench_sink += v.servo_angle[count - 1];
+}
+
+static void run_vessels_tick_1(uint32_t iters) { run_vessels_tick(1, iters); }
+static void run_vessels_tick_2(uint32_t iters) { run_vessels_tick(2, iters); }
+static void run_vessels_tick_3(uint32_t iters) { run_vessels_tick(3, iters); }
+static void run_vessels_tick_4(uint32_t iters) { run_vessels_tick(4, iters); }
+
+// Bytes por operação: draw_string grava 8 colunas por caractere no buffer;
+// update envia 7 bytes de endereçamento + 8 páginas de (1 + 128) bytes;
+// a chama gera 25 palavras de 32 bits; o controle produz ângulo + nível PWM
+// (por panela, nos casos vessels_tick/N).
+//
+// Tolerância no host: numa VM compartilhada há trechos de vários segundos
+// em que a medida inteira fica até ~2,1x (kernels de centenas de ns) e
+// ~2,4x (kernels de poucos ns) mais lenta que a mediana de 30 medidas
+// seguidas. A tolerância de cada kernel cobre esse ruído e ainda acusa
+// regressões de 2,25x (2,5x nos de poucos ns) para cima; no RP2040 vale
+// BENCH_TOLERANCE.
+static const bench_case_t bench_cases[] = {
+    {"ssd1306_draw_string", 2000, 15 * 8,                                  run_draw_string,    1.25},
+    {"ssd1306_update",        20, 7 + DISPLAY_PAGES * (DISPLAY_WIDTH + 1), run_update,         1.25},
+    {"flame_encode_frame",  2000, FLAME_PIXELS * 4,                        run_flame_encode,   1.25},
+    {"control_step",       20000, 3,                                       run_control_step,   1.0},
+    {"vessels_tick/1",     12000, 3,                                       run_vessels_tick_1, 1.5},
+    {"vessels_tick/2",     12000, 3,                                       run_vessels_tick_2, 1.5},
+    {"vessels_tick/3",     12000, 3,                                       run_vessels_tick_3, 1.5},
+    {"vessels_tick/4",     12000, 3,                                       run_vessels_tick_4, 1.5},
+};
+#define NUM_BENCH_CASES (sizeof(bench_cases) / sizeof(bench_cases[0]))
+
+static uint64_t time_run(const bench_case_t* bc, uint32_t iters) {
+    uint64_t t0 = bench_now_ns();
+    bc->run(iters);
+    return bench_now_ns() - t0;
+}
+
+// Mediana por ordenação por inserção (BENCH_REPEATS é pequeno)
+static uint64_t median(uint64_t* v, int n) {
+    for (int i = 1; i < n; i++) {
+        uint64_t x = v[i];
+        int j = i;
+        for (; j > 0 && v[j - 1] > x; j--) v[j] = v[j - 1];
+        v[j] = x;
+    }
+    return v[n / 2];
+}
+
+size_t bench_run_all(bench_result_t* out, size_t max, uint32_t iter_scale) {
+    size_t n = NUM_BENCH_CASES < max ? NUM_BENCH_CASES : max;
+    uint32_t iters[BENCH_MAX_CASES];
+    static uint64_t times[BENCH_MAX_CASES][BENCH_REPEATS];
+    ssd1306_clear();
+
+    for (size_t c = 0; c < n; c++) {
+        const bench_case_t* bc = &bench_cases[c];
+        iters[c] = bc->iters * iter_scale;
+        bc->run(iters[c] / 10 + 1); // Aquecimento (cache do XIP / branch predictor)
+
+        // Repetições curtas demais ficam à mercê de uma única interrupção
+        // ou troca de contexto: dobra as iterações até BENCH_MIN_RUN_NS
+        while (iters[c] < UINT32_MAX / 2 && time_run(bc, iters[c]) < BENCH_MIN_RUN_NS) iters[c] *= 2;
+    }
+
+    // As repetições se intercalam entre os kernels: um trecho em que o host
+    // (ou a cache) fica lento atinge uma repetição de cada caso, e não todas
+    // as de um só, e a mediana de cada caso a ignora
+    for (int r = 0; r < BENCH_REPEATS; r++) {
+        for (size_t c = 0; c < n; c++) {
+            times[c][r] = time_run(&bench_cases[c], iters[c]);
+        }
+    }
+
+    for (size_t c = 0; c < n; c++) {
+        out[c].name = bench_cases[c].name;
+        out[c].iters = iters[c];
+        out[c].ns_per_op = (double)median(times[c], BENCH_REPEATS) / iters[c];
+        out[c].bytes_per_op = bench_cases[c].bytes_per_op;
+    }
+    return n;
+}
+
+void bench_print_table(FILE* f, const char* platform, const bench_result_t* res, size_t n) {
+    fprintf(f, "# U7T bench platform=%s\n", platform);
+    fprintf(f, "%-24s %10s %12s %10s\n", "# kernel", "iters", "ns/op", "bytes/op");
+    for (size_t i = 0; i < n; i++) {
+        fprintf(f, "%-24s %10lu %12.1f %10lu\n", res[i].name, (unsigned long)res[i].iters,
+                res[i].ns_per_op, (unsigned long)res[i].bytes_per_op);
+    }
+}
+
+size_t bench_parse_table(FILE* f, bench_result_t* out, size_t max, char* names, size_t names_len) {
+    char line[128];
+    size_t n = 0;
+    while (n < max && fgets(line, sizeof(line), f)) {
+        char name[32];
+        unsigned long iters, bytes;
+        double ns;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%31s %lu %lf %lu", name, &iters, &ns, &bytes) != 4) continue;
+        size_t len = strlen(name) + 1;
+        if (len > names_len) break;
+        memcpy(names, name, len);
+        out[n].name = names;
+        out[n].iters = (uint32_t)iters;
+        out[n].ns_per_op = ns;
+        out[n].bytes_per_op = (uint32_t)bytes;
+        names += len;
+        names_len -= len;
+        n++;
+    }
+    return n;
+}
+
+double bench_tolerance(const char* name, bool host) {
+    for (size_t c = 0; host && c < NUM_BENCH_CASES; c++) {
+        if (strcmp(bench_cases[c].name, name) == 0) return bench_cases[c].host_tolerance;
+    }
+    return BENCH_TOLERANCE;
+}
+
+int bench_compare(FILE* f, const bench_result_t* res, size_t n,
+                  const bench_result_t* base, size_t base_n, bool host) {
+    int regressions = 0;
+    fprintf(f, "%-24s %12s %12s %8s %6s\n", "# kernel", "baseline", "ns/op", "delta", "tol");
+    for (size_t i = 0; i < n; i++) {
+        const bench_result_t* b = NULL;
+        for (size_t j = 0; j < base_n; j++) {
+            if (strcmp(base[j].name, res[i].name) == 0) { b = &base[j]; break; }
+        }
+        if (!b) {
+            fprintf(f, "%-24s %12s %12.1f %8s\n", res[i].name, "-", res[i].ns_per_op, "novo");
+            continue;
+        }
+        double delta = (res[i].ns_per_op - b->ns_per_op) / b->ns_per_op;
+        double tolerance = bench_tolerance(res[i].name, host);
+        bool regressed = delta > tolerance || res[i].bytes_per_op > b->bytes_per_op;
+        if (regressed) regressions++;
+        fprintf(f, "%-24s %12.1f %12.1f %+7.1f%% %5.0f%%%s\n", res[i].name, b->ns_per_op,
+                res[i].ns_per_op, delta * 100.0, tolerance * 100.0, regressed ? "  REGRESSAO" : "");
+    }
+    return regressions;
+}
@@ -0,0 +1,47 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#define BENCH_MAX_CASES  16
+#define BENCH_REPEATS    9        // Repetições intercaladas por kernel; reporta a mediana
+#define BENCH_MIN_RUN_NS 2000000  // Cada repetição dura pelo menos 2 ms
+#define BENCH_TOLERANCE  0.20     // Regressão quando ns/op passa 20% do baseline (RP2040)
+
+typedef struct {
+    const char* name;
+    uint32_t iters;          // Iterações por repetição no RP2040
+    uint32_t bytes_per_op;   // Bytes escritos no destino (buffer, barramento, FIFO)
+    void (*run)(uint32_t iters);
+    double host_tolerance;   // Tolerância medida no host (ver bench.c)
+} bench_case_t;
+
+typedef struct {
+    const char* name;
+    uint32_t iters;
+    double ns_per_op;
+    uint32_t bytes_per_op;
+} bench_result_t;
+
+// Fornecido por cada plataforma (bench_pico.c / bench_native.c)
+uint64_t bench_now_ns(void);
+
+// Executa todos os kernels; iter_scale multiplica as iterações (build nativo)
+size_t bench_run_all(bench_result_t* out, size_t max, uint32_t iter_scale);
+void bench_print_table(FILE* f, const char* platform, const bench_result_t* res, size_t n);
+
+// Lê uma tabela impressa por bench_print_table (ou um baseline no mesmo formato)
+size_t bench_parse_table(FILE* f, bench_result_t* out, size_t max, char* names, size_t names_len);
+
+// Tolerância do kernel: BENCH_TOLERANCE no RP2040, a do caso no host
+double bench_tolerance(const char* name, bool host);
+
+// Compara com o baseline, cada kernel com a sua tolerância; devolve o
+// número de regressões encontradas
+int bench_compare(FILE* f, const bench_result_t* res, size_t n,
+                  const bench_result_t* base, size_t base_n, bool host);
+
+#endif
@@ -0,0 +1,100 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+#include "hardware/i2c.h"
+#include "lib/ssd1306.h"
+
+extern volatile uint32_t bench_sink;
+
+#define NATIVE_ITER_SCALE 50 // O host é muito mais rápido que o RP2040
+
+i2c_inst_t bench_i2c1;
+absolute_time_t native_clock_us;
+
+int i2c_write_blocking_until(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop,
+                             absolute_time_t until) {
+    (void)addr; (void)nostop; (void)until;
+    i2c->bytes_written += len;
+    bench_sink += src[len - 1];
+    return (int)len;
+}
+
+uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr,
+            "uso: %s [-b baseline.txt] [-w novo_baseline.txt] [-i resultados.txt]\n"
+            "  -b  compara com o baseline e retorna 1 se houver regressao\n"
+            "  -w  grava a tabela medida como novo baseline\n"
+            "  -i  nao executa: le uma tabela capturada (ex.: serial do RP2040)\n",
+            prog);
+}
+
+static size_t load_table(const char* path, bench_result_t* out, char* names, size_t names_len) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        exit(2);
+    }
+    size_t n = bench_parse_table(f, out, BENCH_MAX_CASES, names, names_len);
+    fclose(f);
+    return n;
+}
+
+int main(int argc, char** argv) {
+    const char* baseline_path = NULL;
+    const char* write_path = NULL;
+    const char* input_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && strcmp(argv[i], "-b") == 0) baseline_path = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-w") == 0) write_path = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) input_path = argv[++i];
+        else { usage(argv[0]); return 2; }
+    }
+
+    bench_result_t results[BENCH_MAX_CASES];
+    char result_names[BENCH_MAX_CASES * 32];
+    size_t n;
+    const char* platform = "native";
+
+    if (input_path) {
+        n = load_table(input_path, results, result_names, sizeof(result_names));
+        platform = input_path;
+    } else {
+        ssd1306_init(); // Como no RP2040: barramento configurado e painel inicializado
+        n = bench_run_all(results, BENCH_MAX_CASES, NATIVE_ITER_SCALE);
+    }
+    bench_print_table(stdout, platform, results, n);
+
+    if (write_path) {
+        FILE* f = fopen(write_path, "w");
+        if (!f) {
+            perror(write_path);
+            return 2;
+        }
+        bench_print_table(f, platform, results, n);
+        fclose(f);
+    }
+
+    if (baseline_path) {
+        bench_result_t base[BENCH_MAX_CASES];
+        char base_names[BENCH_MAX_CASES * 32];
+        size_t base_n = load_table(baseline_path, base, base_names, sizeof(base_names));
+        printf("\n");
+        // Tabela capturada do RP2040 (-i): sem o ruído do host
+        int regressions = bench_compare(stdout, results, n, base, base_n, input_path == NULL);
+        if (regressions) {
+            printf("%d regressao(oes) acima da tolerancia de cada kernel\n", regressions);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include <stdio.h>
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "bench.h"
+#include "lib/ssd1306.h"
+
+uint64_t bench_now_ns(void) {
+    return time_us_64() * 1000u;
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000);
+
+    ssd1306_init();
+
+    bench_result_t results[BENCH_MAX_CASES];
+    uint32_t clk_mhz = clock_get_hz(clk_sys) / 1000000;
+
+    while (true) {
+        size_t n = bench_run_all(results, BENCH_MAX_CASES, 1);
+        bench_print_table(stdout, "rp2040", results, n);
+        for (size_t i = 0; i < n; i++) {
+            printf("# %-22s %10.0f ciclos/op @ %lu MHz\n", results[i].name,
+                   results[i].ns_per_op * clk_mhz / 1000.0, (unsigned long)clk_mhz);
+        }
+#if DISPLAY_TRANSPORT == DISPLAY_I2C
+        i2c_bus_print_stats(ssd1306_bus());
+#endif
+        printf("\n");
+        sleep_ms(5000);
+    }
+
+    return 0;
+}
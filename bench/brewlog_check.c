@@ -0,0 +1,299 @@
+// Verificação nativa do registro das corridas (lib/brewlog.c) numa flash NOR
+// simulada: apagar põe 0xFF, programar só limpa bits, e cada operação
+// avança o relógio pelo seu tempo típico. Grava corridas até o anel dar a
+// volta, esgota os setores pré-apagados, perde registros por falta de folga,
+// corta a energia no meio de uma corrida (com um apagamento interrompido) e
+// reinicia com brewlog_init. Cada corrida que sobrou no anel é exportada como
+// o comando "e" faz e decodificada pelo decodificador de referência, que tem
+// de devolver exatamente as amostras gravadas.
+//   ./build-bench/U7T_brewlog_check python3 tools/brewlog_dump.py
+
+#include <stdio.h>
+#include <string.h>
+#include "hardware/flash.h"
+#include "lib/brewlog.h"
+
+#define REGION_OFFSET (PICO_FLASH_SIZE_BYTES - BREWLOG_FLASH_BYTES)
+#define TICK_US       50000 // CONTROL_TICK_MS do firmware
+#define SLACK_US      48000 // Folga de um tick ocioso
+#define PERIOD_MS     100   // Amostras mais densas: o anel dá a volta mais cedo
+#define MAX_RUNS      16
+#define MAX_ROWS      16384
+#define ROW_LEN       96
+
+absolute_time_t native_clock_us;
+char native_flash[PICO_FLASH_SIZE_BYTES];
+
+typedef struct {
+    uint32_t t;
+    uint8_t vessel;
+    int16_t temp;
+    int16_t setpoint;
+    uint8_t angle;
+    uint8_t state;
+} row_t;
+
+// O que foi entregue ao registro em cada corrida, na ordem
+typedef struct {
+    row_t rows[MAX_ROWS];
+    uint32_t count;
+    uint32_t dropped;  // Perdidos por falta de espaço na RAM (marcador 0x81)
+    bool ended;        // Fim gravado (sem corte de energia nem falta de setor)
+} run_truth_t;
+
+static run_truth_t truth[MAX_RUNS];
+static brewlog_t brewlog;
+static vessels_t v;
+static const brassagem_stage_t STAGES[] = {
+    {45.0f, 48.0f, "Acido", 600},
+    {62.0f, 65.0f, "Beta", 1800},
+    {70.0f, 72.5f, "Alfa", 1200},
+};
+static const recipe_t RECIPE = {"Teste", STAGES, 3};
+static uint32_t erases_running, bad_programs, rng = 12345;
+static int failures;
+
+void flash_range_erase(uint32_t flash_offs, size_t count) {
+    if (brewlog.logging) erases_running++;
+    memset(&native_flash[flash_offs], 0xFF, count);
+    native_clock_us += BREWLOG_ERASE_US;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count) {
+    if (flash_offs % FLASH_PAGE_SIZE) bad_programs++;
+    for (size_t i = 0; i < count; i++) {
+        // Programar sobre um byte não apagado corrompe o dado
+        if ((uint8_t)native_flash[flash_offs + i] != 0xFF && data[i] != 0xFF) bad_programs++;
+        native_flash[flash_offs + i] &= (char)data[i];
+    }
+    native_clock_us += 800;
+}
+
+static void check(bool ok, const char* what) {
+    printf("%-56s %s\n", what, ok ? "ok" : "FALHOU");
+    if (!ok) failures++;
+}
+
+static uint32_t next_rand(void) {
+    rng = rng * 1103515245u + 12345u;
+    return rng >> 16;
+}
+
+// Amostra como o codificador a descreve (brewlog.h)
+static row_t expected_row(uint8_t i, uint32_t t) {
+    row_t r = {.t = t, .vessel = i, .temp = (int16_t)(v.temperature[i] * 16.0f), .angle = v.servo_angle[i]};
+    r.state = BREWLOG_S_STAGE;
+    if (vessel_running(&v, i)) {
+        const brassagem_stage_t* stage = vessel_current_stage(&v, i);
+        r.setpoint = (int16_t)((stage->temp_min + stage->temp_max) * 8.0f);
+        r.state = v.stage[i];
+    }
+    if (v.flame_active[i]) r.state |= BREWLOG_S_FLAME;
+    if (v.timer_active[i]) r.state |= BREWLOG_S_TIMER;
+    if (v.timer_finished[i]) r.state |= BREWLOG_S_FINISHED;
+    if (v.sensor[i] >= 0 && v.measured_ok[i]) r.state |= BREWLOG_S_SENSOR;
+    return r;
+}
+
+// Mesma linha que tools/brewlog_dump.py imprime
+static void format_row(const row_t* r, char* out) {
+    char stage[4] = "";
+    if ((r->state & BREWLOG_S_STAGE) != BREWLOG_S_STAGE) snprintf(stage, sizeof(stage), "%u", r->state & BREWLOG_S_STAGE);
+    snprintf(out, ROW_LEN, "%.2f,%u,%.2f,%.2f,%u,%s,%d,%d,%d,%d\n", r->t * 0.010, r->vessel, r->temp / 16.0,
+             r->setpoint / 16.0, r->angle, stage, !!(r->state & BREWLOG_S_FLAME), !!(r->state & BREWLOG_S_TIMER),
+             !!(r->state & BREWLOG_S_FINISHED), !!(r->state & BREWLOG_S_SENSOR));
+}
+
+// Panelas com temperatura, válvula e estado variando a cada tick
+static void simulate(void) {
+    for (uint8_t i = 0; i < v.count; i++) {
+        if (!vessel_running(&v, i)) continue;
+        v.temperature[i] += (float)((int)(next_rand() % 7) - 3) * 0.0625f;
+        if (next_rand() % 4 == 0) v.servo_angle[i] = (uint8_t)(next_rand() % 91);
+        v.flame_active[i] = v.servo_angle[i] > 0;
+        if (next_rand() % 200 == 0) v.stage[i] = (uint8_t)((v.stage[i] + 1) % RECIPE.num_stages);
+        if (next_rand() % 100 == 0) v.timer_active[i] = !v.timer_active[i];
+        if (next_rand() % 300 == 0) v.timer_finished[i] = !v.timer_finished[i];
+        v.measured_ok[i] = next_rand() % 50 != 0;
+    }
+}
+
+// Um tick do laço: simulação, brewlog_tick e o serviço na folga
+static void tick(int64_t slack_us) {
+    native_clock_us = (native_clock_us / TICK_US + 1) * TICK_US;
+    simulate();
+    uint32_t records = brewlog.records, dropped = brewlog.dropped, starved = brewlog.starved;
+    brewlog_tick(&brewlog, &v, (uint32_t)(native_clock_us / 1000));
+    if (brewlog.logging) {
+        run_truth_t* run = &truth[brewlog.run % MAX_RUNS];
+        uint32_t t = ((uint32_t)(native_clock_us / 1000) - brewlog.run_start_ms) / BREWLOG_TIME_UNIT_MS;
+        // Uma amostra perdida leva as seguintes do mesmo tick
+        for (uint8_t i = 0; i < brewlog.records - records && run->count < MAX_ROWS; i++) {
+            run->rows[run->count++] = expected_row(i, t);
+        }
+        if (brewlog.starved == starved) run->dropped += brewlog.dropped - dropped;
+        if (brewlog.starved != starved) run->ended = false;
+    }
+    brewlog_service(&brewlog, (absolute_time_t)(native_clock_us + slack_us));
+}
+
+static void idle(uint32_t ms) {
+    for (uint32_t t = 0; t < ms * 1000u; t += TICK_US) tick(SLACK_US);
+}
+
+static uint16_t start_run(void) {
+    for (uint8_t i = 0; i < v.count; i++) v.stage[i] = (uint8_t)(i % RECIPE.num_stages);
+    v.stage[2] = VESSEL_IDLE; // Uma panela parada também é registrada
+    uint16_t run = brewlog.run;
+    memset(&truth[run % MAX_RUNS], 0, sizeof(truth[0]));
+    truth[run % MAX_RUNS].ended = true;
+    return run;
+}
+
+static void stop_run(void) {
+    for (uint8_t i = 0; i < v.count; i++) v.stage[i] = VESSEL_IDLE;
+    tick(SLACK_US);
+}
+
+// Corrida de ms; com busy, o laço fica 12 s sem folga para a flash no meio
+static uint16_t run_for(uint32_t ms, bool busy) {
+    uint16_t run = start_run();
+    for (uint32_t t = 0; t < ms * 1000u; t += TICK_US) {
+        tick(busy && t >= 5000000u && t < 17000000u ? 0 : SLACK_US);
+    }
+    stop_run();
+    idle(5000); // Última página e pré-apagamento
+    return run;
+}
+
+static const uint8_t* sector_data(uint16_t sector) {
+    return (const uint8_t*)&native_flash[REGION_OFFSET + (uint32_t)sector * BREWLOG_SECTOR_SIZE];
+}
+
+static const brewlog_sector_t* sector_header(uint16_t sector) {
+    const brewlog_sector_t* h = (const brewlog_sector_t*)sector_data(sector);
+    return h->magic == BREWLOG_MAGIC ? h : NULL;
+}
+
+// Exporta a corrida como o comando "e" (setores na ordem do anel), decodifica
+// e compara as amostras com as entregues ao registro
+static void check_run(const char* decoder, uint16_t run) {
+    static char decoded_rows[MAX_ROWS][ROW_LEN];
+    const run_truth_t* tr = &truth[run % MAX_RUNS];
+    char path[32], cmd[512], line[ROW_LEN], want[ROW_LEN], what[64];
+
+    snprintf(path, sizeof(path), "brewlog_run%u.bin", run);
+    FILE* f = fopen(path, "wb");
+    bool from_start = false;
+    for (uint16_t k = 0; k < BREWLOG_SECTORS; k++) {
+        const brewlog_sector_t* h = sector_header((brewlog.next_free + k) % BREWLOG_SECTORS);
+        if (!h || h->run != run) continue;
+        if (h->index == 0) from_start = true;
+        fwrite(h, 1, BREWLOG_SECTOR_SIZE, f);
+    }
+    fclose(f);
+
+    snprintf(cmd, sizeof(cmd), "%s --file %s", decoder, path);
+    FILE* p = popen(cmd, "r");
+    uint32_t decoded = 0, lost = 0;
+    bool header = false, end = false;
+    while (p && fgets(line, sizeof(line), p)) {
+        unsigned n;
+        if (sscanf(line, "# corrida %u", &n) == 1) header = n == run;
+        if (strncmp(line, "# fim", 5) == 0) end = true;
+        if (sscanf(line, "# %u registros perdidos", &n) == 1) lost += n;
+        if (line[0] == '#' || strncmp(line, "tempo_s", 7) == 0) continue;
+        if (decoded < MAX_ROWS) memcpy(decoded_rows[decoded], line, ROW_LEN);
+        decoded++;
+    }
+    bool ran = p && pclose(p) == 0;
+    remove(path);
+
+    // Sem o início (sobrescrito), as amostras decodificadas são o fim da corrida
+    uint32_t first = (!from_start && tr->count > decoded) ? tr->count - decoded : 0;
+    uint32_t mismatches = 0;
+    for (uint32_t i = 0; i < decoded; i++) {
+        if (i >= MAX_ROWS || first + i >= tr->count) {
+            mismatches++;
+            continue;
+        }
+        format_row(&tr->rows[first + i], want);
+        if (strcmp(decoded_rows[i], want) != 0) mismatches++;
+    }
+
+    bool whole = from_start && tr->ended;
+    snprintf(what, sizeof(what), "corrida %u: %lu amostras %s", run, (unsigned long)decoded,
+             whole ? "completas" : from_start ? "do inicio (sem o fim)" : "do fim (inicio sobrescrito)");
+    check(ran && decoded > 0 && mismatches == 0 && (!whole || decoded == tr->count), what);
+    if (from_start) check(header, "  cabecalho da corrida no primeiro setor");
+    check(end == tr->ended && (!from_start || lost == tr->dropped), "  marcadores de fim e de perdidos");
+}
+
+int main(int argc, char** argv) {
+    char decoder[400] = "";
+    if (argc >= 3) snprintf(decoder, sizeof(decoder), "\"%s\" \"%s\"", argv[1], argv[2]);
+
+    // Região com lixo de um firmware anterior
+    memset(native_flash, 0x5A, sizeof(native_flash));
+    memset(&v, 0, sizeof(v));
+    v.count = 3;
+    for (uint8_t i = 0; i < v.count; i++) {
+        v.recipe[i] = &RECIPE;
+        v.stage[i] = VESSEL_IDLE;
+        v.sensor[i] = i == 1 ? 0 : -1;
+        v.temperature[i] = 40.0f + i;
+    }
+    native_clock_us = 1000000;
+
+    brewlog_init(&brewlog);
+    brewlog.period_ms = PERIOD_MS;
+    check(brewlog.enabled && brewlog.run == 1 && brewlog.erased_ahead == 0, "flash com lixo: anel vazio, nada apagado");
+    idle(5000);
+    check(brewlog.erased_ahead == BREWLOG_ERASE_AHEAD, "pre-apagamento com as panelas paradas");
+
+    // Corridas até o anel dar a volta
+    for (int r = 0; r < 8; r++) run_for(100000, false);
+    check(brewlog.serial > BREWLOG_SECTORS, "anel deu a volta");
+
+    // Corrida maior que os setores pré-apagados: perde amostras, não apaga
+    uint32_t starved = brewlog.starved;
+    run_for(300000, false);
+    check(brewlog.starved > starved, "setores prontos esgotados: amostras perdidas");
+    check(erases_running == 0, "nenhum apagamento com panela em execucao");
+
+    // Corte de energia no meio de uma corrida; o apagamento seguinte também
+    // foi interrompido (metade do setor apagada)
+    uint16_t cut_run = start_run();
+    for (uint32_t t = 0; t < 40000000u; t += TICK_US) tick(SLACK_US);
+    truth[cut_run % MAX_RUNS].ended = false;
+    uint16_t last_sector = brewlog.sector;
+    uint32_t serial = brewlog.serial;
+    uint16_t torn = (last_sector + 1) % BREWLOG_SECTORS;
+    memset((char*)sector_data(torn), 0xFF, BREWLOG_SECTOR_SIZE / 2);
+    memset((char*)sector_data(torn) + BREWLOG_SECTOR_SIZE / 2, 0x5A, BREWLOG_SECTOR_SIZE / 2);
+
+    brewlog_init(&brewlog);
+    brewlog.period_ms = PERIOD_MS;
+    for (uint8_t i = 0; i < v.count; i++) v.stage[i] = VESSEL_IDLE;
+    check(brewlog.next_free == torn && brewlog.serial == serial && brewlog.run == cut_run + 1,
+          "reinicio retoma o anel apos a ultima corrida");
+    check(brewlog.erased_ahead == 0, "setor com apagamento interrompido nao conta como pronto");
+    idle(5000);
+    uint16_t busy_run = run_for(30000, true);
+    check(truth[busy_run % MAX_RUNS].dropped > 0, "registros perdidos sem folga para a flash");
+    check(bad_programs == 0, "programacao so sobre paginas apagadas");
+
+    if (!decoder[0]) {
+        printf("decodificador nao informado: ida e volta nao verificada\n");
+        return failures ? 1 : 0;
+    }
+    for (uint16_t run = 1; run < brewlog.run; run++) {
+        bool present = false;
+        for (uint16_t s = 0; s < BREWLOG_SECTORS; s++) {
+            const brewlog_sector_t* h = sector_header(s);
+            present |= h && h->run == run;
+        }
+        if (present) check_run(decoder, run);
+    }
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,142 @@
+// Verificação nativa do barramento do display com um relógio simulado: cada
+// escrita avança o relógio pelo seu tempo nominal (endereço + dados, 9 bits
+// por byte) na velocidade configurada, e estoura o prazo como o SDK se não
+// couber. Confere que um quadro inteiro passa a 1 MHz e, após o recuo, a
+// 400 kHz, sempre dentro de DISPLAY_MAX_BLOCK_US, e que o barramento volta a
+// 1 MHz após I2C_BUS_STEP_UP_TRANSFERS escritas sem erro. O envio em
+// páginas (ssd1306_service) nunca passa do prazo do tick, nem com um NAK no
+// meio do quadro.
+//   ./build-bench/U7T_i2c_check
+
+#include <stdio.h>
+#include "hardware/i2c.h"
+#include "lib/ssd1306.h"
+
+i2c_inst_t bench_i2c1;
+absolute_time_t native_clock_us;
+
+static int naks_to_inject;  // Próximas escritas recusadas com NAK
+static bool stuck;          // Escravo segurando o barramento: tudo estoura
+static int failures;
+
+int i2c_write_blocking_until(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop,
+                             absolute_time_t until) {
+    (void)addr; (void)src; (void)nostop;
+    if (naks_to_inject > 0) {
+        naks_to_inject--;
+        native_clock_us += 9000000ull / i2c->baudrate; // Só o byte de endereço
+        return PICO_ERROR_GENERIC;
+    }
+    uint64_t nominal_us = (len + 1) * 9000000ull / i2c->baudrate;
+    if (stuck || native_clock_us + nominal_us > until) {
+        if (until > native_clock_us) native_clock_us = until;
+        return PICO_ERROR_TIMEOUT;
+    }
+    native_clock_us += nominal_us;
+    i2c->bytes_written += len;
+    return (int)len;
+}
+
+static void check(bool ok, const char* what) {
+    printf("%-48s %s\n", what, ok ? "ok" : "FALHOU");
+    if (!ok) failures++;
+}
+
+// Envia o quadro pedido com slack_us de folga por tick, como o laço faz.
+// Devolve os ticks gastos (0 se algum passou do prazo ou não terminou).
+static int paced_flush(uint32_t slack_us) {
+    ssd1306_request_update();
+    for (int tick = 1; tick <= 4 * DISPLAY_PAGES; tick++) {
+        absolute_time_t deadline = native_clock_us + slack_us;
+        bool done = ssd1306_service(deadline);
+        if (native_clock_us > deadline) return 0;
+        if (done) return tick;
+        native_clock_us = deadline;
+    }
+    return 0;
+}
+
+// Atualiza o display e devolve o tempo bloqueado
+static uint64_t timed_update(bool* ok) {
+    absolute_time_t start = native_clock_us;
+    *ok = ssd1306_update();
+    return native_clock_us - start;
+}
+
+int main(void) {
+    const i2c_bus_t* bus = ssd1306_bus();
+    bool ok;
+
+    ssd1306_init();
+    check(bus->actual_hz == DISPLAY_I2C_HZ && bus->timeouts == 0 && bus->naks == 0,
+          "inicializacao na velocidade pedida sem erros");
+
+    uint64_t us = timed_update(&ok);
+    check(ok && bus->timeouts == 0, "quadro inteiro na velocidade pedida");
+    check(us <= DISPLAY_MAX_BLOCK_US, "quadro na velocidade pedida dentro do limite");
+
+    // Erros seguidos derrubam a velocidade para o piso
+    for (int i = 0; i < I2C_BUS_FALLBACK_ERRORS; i++) {
+        naks_to_inject = 1;
+        us = timed_update(&ok);
+        check(!ok && us <= DISPLAY_MAX_BLOCK_US, "NAK devolve erro dentro do limite");
+    }
+    check(bus->actual_hz == DISPLAY_I2C_MIN_HZ && bus->fallbacks == 1, "recuo para a velocidade minima");
+
+    uint32_t timeouts = bus->timeouts;
+    us = timed_update(&ok); // Reinicializa o painel junto com o quadro
+    check(ok && bus->timeouts == timeouts, "quadro inteiro com reinicializacao no piso");
+    check(us <= DISPLAY_MAX_BLOCK_US, "quadro no piso dentro do limite");
+    us = timed_update(&ok);
+    check(ok && us <= DISPLAY_MAX_BLOCK_US, "quadro inteiro no piso");
+
+    // Escravo preso: estouro do prazo + recuperação ainda dentro do limite
+    stuck = true;
+    us = timed_update(&ok);
+    stuck = false;
+    check(!ok && bus->timeouts == timeouts + 1, "barramento preso devolve erro");
+    check(us <= DISPLAY_MAX_BLOCK_US, "estouro com recuperacao dentro do limite");
+
+    // Escritas sem erro no piso: volta à velocidade pedida
+    uint32_t transfers = bus->transfers;
+    while (bus->step_ups == 0 && bus->transfers - transfers <= I2C_BUS_STEP_UP_TRANSFERS) {
+        us = timed_update(&ok);
+        if (!ok || us > DISPLAY_MAX_BLOCK_US) break;
+    }
+    check(ok && bus->actual_hz == DISPLAY_I2C_HZ && bus->step_ups == 1, "subida apos escritas sem erro");
+    check(bus->transfers - transfers >= I2C_BUS_STEP_UP_TRANSFERS, "subida so apos I2C_BUS_STEP_UP_TRANSFERS");
+    us = timed_update(&ok);
+    check(ok && us <= DISPLAY_MAX_BLOCK_US, "quadro inteiro de volta na velocidade pedida");
+
+    // Enlace que não aguenta a velocidade: recua de novo
+    for (int i = 0; i < I2C_BUS_FALLBACK_ERRORS; i++) {
+        naks_to_inject = 1;
+        timed_update(&ok);
+    }
+    check(bus->actual_hz == DISPLAY_I2C_MIN_HZ && bus->fallbacks == 2, "novo recuo apos a subida");
+
+    // Envio em páginas na folga do tick, no piso
+    uint32_t transfers_before = bus->transfers;
+    ssd1306_request_update();
+    ssd1306_service(native_clock_us + 1000);
+    check(bus->transfers == transfers_before, "folga menor que uma pagina: nada enviado");
+    int ticks = paced_flush(10000);
+    check(ticks > 1 && ticks <= DISPLAY_PAGES, "quadro em paginas, sem passar do prazo do tick");
+    naks_to_inject = 0;
+    ssd1306_request_update();
+    ssd1306_service(native_clock_us + 10000);
+    naks_to_inject = 1;
+    absolute_time_t deadline = native_clock_us + 10000;
+    ok = ssd1306_service(deadline);
+    check(!ok && native_clock_us <= deadline, "NAK no meio do quadro dentro do prazo");
+    check(paced_flush(10000) > 0, "quadro recomeca e termina apos o NAK");
+    // O pior caso conta o dobro do tempo nominal: no piso, dois ticks
+    ticks = paced_flush(40000);
+    check(ticks > 0 && ticks <= 2, "folga de 40 ms: quadro em ate dois ticks");
+
+    printf("%lu us no pior quadro permitido, limite %lu us\n",
+           (unsigned long)(DISPLAY_FRAME_BYTES * 9ull * 1000000u / DISPLAY_I2C_MIN_HZ),
+           (unsigned long)DISPLAY_MAX_BLOCK_US);
+    i2c_bus_print_stats(bus);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,24 @@
+#ifndef BENCH_NATIVE_HARDWARE_FLASH_H
+#define BENCH_NATIVE_HARDWARE_FLASH_H
+
+// Flash NOR simulada numa imagem em RAM, visível pelo XIP em XIP_BASE. O
+// binário ocupa os primeiros NATIVE_BINARY_BYTES. Quem usa o substituto
+// define a imagem (PICO_FLASH_SIZE_BYTES bytes) e as operações: apagar põe
+// 0xFF, programar só limpa bits.
+
+#include "pico/stdlib.h"
+
+#define PICO_FLASH_SIZE_BYTES (2u * 1024u * 1024u)
+#define FLASH_PAGE_SIZE       256u
+#define FLASH_SECTOR_SIZE     4096u
+#define NATIVE_BINARY_BYTES   4096u
+
+extern char native_flash[];
+#define XIP_BASE ((uintptr_t)native_flash)
+// Fim do binário que o linker do SDK exporta, dentro da imagem
+#define __flash_binary_end native_flash[NATIVE_BINARY_BYTES]
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t* data, size_t count);
+
+#endif
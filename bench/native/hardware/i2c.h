@@ -0,0 +1,32 @@
+#ifndef BENCH_NATIVE_HARDWARE_I2C_H
+#define BENCH_NATIVE_HARDWARE_I2C_H
+
+// Barramento I2C simulado: contabiliza os bytes escritos e guarda a
+// velocidade configurada. A escrita é definida por quem usa o substituto
+// (bench_native.c só conta, i2c_check.c simula o tempo e as falhas).
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    size_t bytes_written;
+    uint baudrate;
+} i2c_inst_t;
+
+extern i2c_inst_t bench_i2c1;
+#define i2c1 (&bench_i2c1)
+
+static inline uint i2c_init(i2c_inst_t *i2c, uint baudrate) {
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+static inline void i2c_deinit(i2c_inst_t *i2c) {
+    (void)i2c;
+}
+
+// Fora de linha, para o compilador não eliminar a montagem do buffer que o
+// kernel entrega ao barramento
+int i2c_write_blocking_until(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop,
+                             absolute_time_t until);
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef BENCH_NATIVE_HARDWARE_IRQ_H
+#define BENCH_NATIVE_HARDWARE_IRQ_H
+
+// Controlador de interrupções simulado: o teste guarda o tratador
+// registrado e o chama quando o alarme do timer simulado vence.
+
+#include "pico/stdlib.h"
+
+#define TIMER_IRQ_0 0
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+static inline void irq_set_priority(uint num, uint8_t priority) { (void)num; (void)priority; }
+static inline void irq_set_enabled(uint num, bool enabled) { (void)num; (void)enabled; }
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef BENCH_NATIVE_HARDWARE_PIO_H
+#define BENCH_NATIVE_HARDWARE_PIO_H
+
+// Só o tipo do bloco PIO, para os cabeçalhos que o guardam (ds18b20.h)
+
+#include "pico/stdlib.h"
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t* PIO;
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef BENCH_NATIVE_HARDWARE_PWM_H
+#define BENCH_NATIVE_HARDWARE_PWM_H
+
+// PWM simulado: a escrita do nível é definida por quem usa o substituto
+// (safety_check.c guarda o último nível de cada canal).
+
+#include "pico/stdlib.h"
+
+void pwm_set_chan_level(uint slice, uint chan, uint16_t level);
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef BENCH_NATIVE_HARDWARE_STRUCTS_WATCHDOG_H
+#define BENCH_NATIVE_HARDWARE_STRUCTS_WATCHDOG_H
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    volatile uint32_t load;
+    volatile uint32_t scratch[8];
+} watchdog_hw_t;
+
+extern watchdog_hw_t native_watchdog_hw;
+#define watchdog_hw (&native_watchdog_hw)
+
+#endif
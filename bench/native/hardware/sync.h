@@ -0,0 +1,12 @@
+#ifndef BENCH_NATIVE_HARDWARE_SYNC_H
+#define BENCH_NATIVE_HARDWARE_SYNC_H
+
+// Um único fluxo de execução: mascarar interrupções não tem efeito. Quem
+// simula uma interrupção a chama entre as operações do teste.
+
+#include "pico/stdlib.h"
+
+static inline uint32_t save_and_disable_interrupts(void) { return 0; }
+static inline void restore_interrupts(uint32_t status) { (void)status; }
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef BENCH_NATIVE_HARDWARE_TIMER_H
+#define BENCH_NATIVE_HARDWARE_TIMER_H
+
+// Registradores do timer simulados numa estrutura comum. O teste mantém
+// timerawl igual ao relógio simulado e dispara o alarme armado.
+
+#include "pico/stdlib.h"
+
+typedef struct {
+    volatile uint32_t alarm[4];
+    volatile uint32_t timerawl;
+    volatile uint32_t intr;
+    volatile uint32_t inte;
+} timer_hw_t;
+
+extern timer_hw_t native_timer_hw;
+#define timer_hw (&native_timer_hw)
+
+static inline void hw_set_bits(volatile uint32_t* addr, uint32_t mask) { *addr |= mask; }
+static inline uint hardware_alarm_claim_unused(bool required) { (void)required; return 0; }
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef BENCH_NATIVE_HARDWARE_WATCHDOG_H
+#define BENCH_NATIVE_HARDWARE_WATCHDOG_H
+
+// Watchdog simulado: o teste define se o último reinício foi dele e
+// confere as recargas no registrador (hardware/structs/watchdog.h).
+
+#include "pico/stdlib.h"
+
+extern bool native_watchdog_reboot;
+
+static inline void watchdog_enable(uint32_t delay_ms, bool pause_on_debug) {
+    (void)delay_ms; (void)pause_on_debug;
+}
+static inline bool watchdog_enable_caused_reboot(void) { return native_watchdog_reboot; }
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef BENCH_NATIVE_PICO_STDLIB_H
+#define BENCH_NATIVE_PICO_STDLIB_H
+
+// Substituto mínimo de pico/stdlib.h para o build nativo dos benchmarks.
+// Só cobre o que os kernels medidos usam; nada aqui toca hardware.
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned int uint;
+
+#define GPIO_FUNC_I2C 3
+#define GPIO_IN  false
+#define GPIO_OUT true
+
+#define PICO_ERROR_TIMEOUT -1
+#define PICO_ERROR_GENERIC -2
+
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+#define __not_in_flash_func(func) func
+
+typedef uint64_t absolute_time_t;
+
+// Relógio simulado em µs. Nos benchmarks ele fica parado: os prazos do
+// barramento nunca vencem e o tempo no barramento fica zero, então só o
+// preparo do quadro entra na medida. O teste do barramento o avança com o
+// tempo nominal de cada transferência.
+extern absolute_time_t native_clock_us;
+
+static inline void sleep_ms(uint32_t ms) { (void)ms; }
+static inline void busy_wait_us(uint64_t us) { native_clock_us += us; }
+static inline void gpio_set_function(uint gpio, int fn) { (void)gpio; (void)fn; }
+static inline void gpio_pull_up(uint gpio) { (void)gpio; }
+static inline void gpio_init(uint gpio) { (void)gpio; }
+static inline void gpio_set_dir(uint gpio, bool out) { (void)gpio; (void)out; }
+static inline void gpio_put(uint gpio, bool value) { (void)gpio; (void)value; }
+static inline bool gpio_get(uint gpio) { (void)gpio; return true; }
+// Nenhum console no build nativo
+static inline int getchar_timeout_us(uint32_t us) { (void)us; return PICO_ERROR_TIMEOUT; }
+
+static inline uint32_t time_us_32(void) { return (uint32_t)native_clock_us; }
+static inline absolute_time_t get_absolute_time(void) { return native_clock_us; }
+static inline absolute_time_t delayed_by_us(absolute_time_t t, uint64_t us) { return t + us; }
+static inline absolute_time_t make_timeout_time_us(uint64_t us) { return native_clock_us + us; }
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) { return native_clock_us + ms * 1000ull; }
+static inline bool time_reached(absolute_time_t t) { return native_clock_us >= t; }
+static inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+
+// Só o tipo: nenhum timer repetitivo roda no build nativo
+typedef struct {
+    int64_t delay_us;
+    void* user_data;
+} repeating_timer_t;
+
+#endif
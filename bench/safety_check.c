@@ -0,0 +1,208 @@
+// Verificação nativa do intertravamento (lib/safety.c) com timer, PWM e
+// watchdog simulados: a interrupção dispara no alvo do alarme enquanto o
+// relógio avança e, com as interrupções mascaradas, uma única vez ao
+// desmascarar. Confere cada motivo de desarme, que as válvulas fecham e o
+// buzzer soa na própria interrupção, que a reação cabe em
+// SAFETY_REACTION_BOUND_US mesmo com a programação de uma página da flash
+// no meio, e que o watchdog só é alimentado com o laço vivo.
+//   ./build-bench/U7T_safety_check
+
+#include <stdio.h>
+#include <string.h>
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/watchdog.h"
+#include "lib/safety.h"
+
+absolute_time_t native_clock_us;
+timer_hw_t native_timer_hw;
+watchdog_hw_t native_watchdog_hw;
+bool native_watchdog_reboot;
+
+#define BUZZER_SLICE 7
+#define BUZZER_LEVEL 500
+#define TICK_US      50000 // CONTROL_TICK_MS do firmware
+
+static irq_handler_t isr;
+static uint16_t pwm_level[8];
+static uint16_t servo_levels[SERVO_MAX_ANGLE + 1];
+static servo_t valves[2];
+static pwm_channel_t buzzer = {.slice = BUZZER_SLICE};
+static ds18b20_bus_t probes;
+static vessels_t v;
+static safety_t safety;
+static int failures;
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+    (void)num;
+    isr = handler;
+}
+
+void pwm_set_chan_level(uint slice, uint chan, uint16_t level) {
+    (void)chan;
+    pwm_level[slice] = level;
+}
+
+static void check(bool ok, const char* what) {
+    printf("%-56s %s\n", what, ok ? "ok" : "FALHOU");
+    if (!ok) failures++;
+}
+
+static void set_clock(absolute_time_t t) {
+    native_clock_us = t;
+    native_timer_hw.timerawl = (uint32_t)t;
+}
+
+// Interrupções liberadas: o alarme dispara exatamente no seu alvo
+static void run_us(uint32_t us) {
+    absolute_time_t end = native_clock_us + us;
+    for (;;) {
+        int32_t wait = (int32_t)(native_timer_hw.alarm[0] - (uint32_t)native_clock_us);
+        absolute_time_t at = native_clock_us + (wait > 0 ? (uint32_t)wait : 0);
+        if (at > end) break;
+        set_clock(at);
+        isr();
+    }
+    set_clock(end);
+}
+
+// Interrupções mascaradas por us µs: o alarme vencido no meio fica pendente
+static void masked_us(uint32_t us) {
+    set_clock(native_clock_us + us);
+    run_us(0);
+}
+
+// Nova leitura da sonda do canal 0, como o timer do 1-Wire a publica
+static void probe_publish(float temp_c) {
+    uint16_t seq = (uint16_t)((probes.sample[0] >> 16) + 1);
+    probes.sample[0] = ((uint32_t)seq << 16) | (uint16_t)(int16_t)(temp_c * 16.0f);
+}
+
+// Ticks do laço de controle: prova de vida, entradas e válvulas
+static void loop_ms(uint32_t ms, bool fresh_probe) {
+    for (uint32_t t = 0; t < ms * 1000u; t += TICK_US) {
+        if (fresh_probe) probe_publish(v.measured[0]);
+        safety_publish(&safety, &v);
+        for (uint8_t i = 0; i < v.count; i++) safety_set_valve(&safety, i, v.servo_angle[i]);
+        run_us(TICK_US);
+    }
+}
+
+static bool valves_closed(void) {
+    return pwm_level[0] == servo_levels[0] && pwm_level[1] == servo_levels[0];
+}
+
+static void start(void) {
+    memset(&v, 0, sizeof(v));
+    v.count = 2;
+    v.sensor[0] = 0;  // Panela 0 com a sonda do canal 0
+    v.sensor[1] = -1; // Panela 1 pela temperatura publicada
+    v.measured[0] = 60.0f;
+    v.temperature[0] = 60.0f;
+    v.temperature[1] = 60.0f;
+    memset(&probes, 0, sizeof(probes));
+    probes.probe_count = 1;
+    probe_publish(60.0f);
+    memset(pwm_level, 0, sizeof(pwm_level));
+    safety_init(&safety, valves, v.count, &buzzer, BUZZER_LEVEL, v.sensor, &probes);
+}
+
+int main(void) {
+    for (int a = 0; a <= SERVO_MAX_ANGLE; a++) servo_levels[a] = (uint16_t)(1000 + a);
+    for (int i = 0; i < 2; i++) {
+        valves[i].pwm.slice = (uint)i;
+        valves[i].levels = servo_levels;
+    }
+    set_clock(1000000);
+
+    start();
+    v.servo_angle[0] = 60;
+    loop_ms(1000, true);
+    check(!safety_tripped(&safety) && pwm_level[0] == servo_levels[60], "laco vivo, leituras novas: armado");
+    check(native_watchdog_hw.load == SAFETY_WATCHDOG_MS * 1000u * 2u, "watchdog recarregado pela interrupcao");
+    check(safety.overruns == 0 && safety.max_gap_us <= SAFETY_PERIOD_US, "uma verificacao por periodo");
+
+    // Programação de uma página com a válvula aberta: dentro do limite
+    masked_us(BREWLOG_IRQ_OFF_MAX_US);
+    loop_ms(100, true);
+    check(safety.overruns == 0 && safety.max_gap_us <= SAFETY_REACTION_BOUND_US,
+          "pagina da flash mascarada dentro do limite");
+
+    // Sobretemperatura publicada logo antes do pior trecho mascarado
+    v.temperature[1] = SAFETY_TEMP_MAX_C + 1;
+    safety_publish(&safety, &v);
+    absolute_time_t published = native_clock_us;
+    masked_us(BREWLOG_IRQ_OFF_MAX_US);
+    while (!safety_tripped(&safety) && native_clock_us - published <= 2 * SAFETY_REACTION_BOUND_US) run_us(10);
+    check(safety.reason == SAFETY_OVERTEMP && safety.trip_vessel == 1, "sobretemperatura desarma");
+    check(native_clock_us - published <= SAFETY_REACTION_BOUND_US, "reacao dentro de SAFETY_REACTION_BOUND_US");
+    check(valves_closed() && pwm_level[BUZZER_SLICE] == BUZZER_LEVEL, "valvulas fechadas e buzzer na interrupcao");
+    check((native_watchdog_hw.scratch[0] & 0xFF) == SAFETY_OVERTEMP, "motivo guardado no rascunho do watchdog");
+
+    safety_set_valve(&safety, 0, 90);
+    check(pwm_level[0] == servo_levels[0], "laco nao reabre a valvula desarmada");
+    safety_reset(&safety);
+    loop_ms(100, true);
+    check(safety.reason == SAFETY_OVERTEMP && valves_closed(), "rearme com a condicao presente desarma de novo");
+    v.temperature[1] = 60.0f;
+    loop_ms(100, true);
+    safety_reset(&safety);
+    loop_ms(100, true);
+    check(!safety_tripped(&safety) && pwm_level[BUZZER_SLICE] == 0 && pwm_level[0] == servo_levels[60],
+          "rearme com a condicao resolvida");
+
+    // Sonda muda com a válvula aberta
+    loop_ms(SAFETY_SENSOR_MAX_AGE_MS - 200, false);
+    check(!safety_tripped(&safety), "sonda muda antes do prazo: armado");
+    loop_ms(300, false);
+    check(safety.reason == SAFETY_SENSOR_STALE && safety.trip_vessel == 0 && valves_closed(),
+          "sonda muda com a valvula aberta desarma");
+
+    // Válvula travada: fechada e a panela continua esquentando
+    start();
+    v.servo_angle[0] = 60;
+    loop_ms(500, true);
+    v.servo_angle[0] = 0;
+    loop_ms(500, true);
+    v.measured[0] = 60.0f + SAFETY_STUCK_RISE_C - 1;
+    loop_ms(1000, true);
+    check(!safety_tripped(&safety), "subida pequena apos fechar: armado");
+    v.measured[0] = 60.0f + SAFETY_STUCK_RISE_C + 1;
+    loop_ms(1000, true);
+    check(safety.reason == SAFETY_STUCK_VALVE && safety.trip_vessel == 0, "valvula travada desarma");
+
+    // Panelas paradas: o apagamento de um setor não conta como estouro
+    start();
+    loop_ms(500, true);
+    masked_us(BREWLOG_ERASE_MAX_US);
+    loop_ms(500, true);
+    check(!safety_tripped(&safety) && safety.overruns == 0 && safety.max_gap_us <= SAFETY_PERIOD_US,
+          "apagamento com as valvulas fechadas fora da medida");
+    v.servo_angle[0] = 60;
+    loop_ms(100, true);
+    masked_us(SAFETY_REACTION_BOUND_US + 1000);
+    check(safety.overruns == 1, "intervalo acima do limite com valvula aberta contado");
+
+    // Laço travado: desarma e para de alimentar o watchdog
+    start();
+    loop_ms(500, true);
+    run_us(SAFETY_LOOP_TIMEOUT_MS * 1000u - TICK_US - 1000);
+    check(!safety_tripped(&safety), "laco atrasado antes do prazo: armado");
+    run_us(TICK_US + 2000);
+    check(safety.reason == SAFETY_LOOP_STALL && valves_closed(), "laco travado desarma");
+    native_watchdog_hw.load = 0;
+    run_us(10000);
+    check(native_watchdog_hw.load == 0, "laco travado: watchdog sem recarga");
+
+    // Reinício pelo watchdog: o alarme continua até o operador rearmar
+    native_watchdog_reboot = true;
+    start();
+    native_watchdog_reboot = false;
+    loop_ms(100, true);
+    check(safety.reason == SAFETY_REBOOT && valves_closed(), "reinicio pelo watchdog mantem o alarme");
+
+    printf("limite de reacao %u us, pior caso medido %lu us\n", (unsigned)SAFETY_REACTION_BOUND_US,
+           (unsigned long)safety_worst_case_us(&safety));
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,432 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "brewlog.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+#if LIB_PICO_STDIO_USB
+#include "pico/stdio_usb.h"
+#include "pico/stdio/driver.h"
+#include "tusb.h"
+#endif
+
+#define BREWLOG_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - BREWLOG_FLASH_BYTES)
+#define BREWLOG_PROGRAM_US   1000 // Programação de uma página, com margem
+#define BREWLOG_EXPORT_CHUNK_US 500
+
+_Static_assert(BREWLOG_PAGE_SIZE == FLASH_PAGE_SIZE, "pagina da flash");
+_Static_assert(BREWLOG_SECTOR_SIZE == FLASH_SECTOR_SIZE, "setor da flash");
+_Static_assert(BREWLOG_FLASH_OFFSET % FLASH_SECTOR_SIZE == 0, "regiao do log desalinhada");
+_Static_assert(BREWLOG_ERASE_AHEAD < BREWLOG_SECTORS - 1, "BREWLOG_ERASE_AHEAD grande demais");
+_Static_assert(sizeof(brewlog_sector_t) == 16, "cabecalho do setor");
+
+extern char __flash_binary_end;
+
+static const uint8_t* sector_ptr(uint16_t sector) {
+    return (const uint8_t*)(XIP_BASE + BREWLOG_FLASH_OFFSET + (uint32_t)sector * BREWLOG_SECTOR_SIZE);
+}
+
+static const brewlog_sector_t* sector_header(uint16_t sector) {
+    const brewlog_sector_t* h = (const brewlog_sector_t*)sector_ptr(sector);
+    return (h->magic == BREWLOG_MAGIC && h->version == BREWLOG_VERSION) ? h : NULL;
+}
+
+static bool sector_is_erased(uint16_t sector) {
+    const uint32_t* w = (const uint32_t*)sector_ptr(sector);
+    for (uint32_t i = 0; i < BREWLOG_SECTOR_SIZE / 4; i++) {
+        if (w[i] != 0xFFFFFFFFu) return false;
+    }
+    return true;
+}
+
+// As rotinas da flash do SDK rodam da SRAM; com as interrupções desligadas
+// nada tenta executar do XIP enquanto ele está desativado. Esse é o maior
+// trecho com interrupções mascaradas do firmware (BREWLOG_ERASE_US típico,
+// BREWLOG_ERASE_MAX_US no pior caso), por isso só acontece com as panelas
+// paradas; com alguma em execução só se programa uma página, dentro de
+// BREWLOG_IRQ_OFF_MAX_US (safety.h).
+static void erase_sector(brewlog_t* log, uint16_t sector) {
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_erase(BREWLOG_FLASH_OFFSET + (uint32_t)sector * BREWLOG_SECTOR_SIZE, BREWLOG_SECTOR_SIZE);
+    restore_interrupts(irq);
+    log->sectors_erased++;
+}
+
+static void program_page(brewlog_t* log, uint8_t p) {
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_program(BREWLOG_FLASH_OFFSET + log->page_addr[p], log->page[p], BREWLOG_PAGE_SIZE);
+    restore_interrupts(irq);
+    log->pending[p] = false;
+    log->pages_written++;
+}
+
+static int64_t slack_us(absolute_time_t deadline) {
+    return absolute_time_diff_us(get_absolute_time(), deadline);
+}
+
+void brewlog_init(brewlog_t* log) {
+    memset(log, 0, sizeof(*log));
+    log->period_ms = BREWLOG_PERIOD_MS;
+    log->enabled = (uintptr_t)&__flash_binary_end - XIP_BASE <= BREWLOG_FLASH_OFFSET;
+    if (!log->enabled) {
+        printf("brewlog: binario invade a regiao do log, registro desativado\n");
+        return;
+    }
+
+    // O setor de maior serial é o fim do anel
+    const brewlog_sector_t* newest = NULL;
+    uint16_t newest_sector = 0;
+    for (uint16_t s = 0; s < BREWLOG_SECTORS; s++) {
+        const brewlog_sector_t* h = sector_header(s);
+        if (h && (!newest || (int32_t)(h->serial - newest->serial) > 0)) {
+            newest = h;
+            newest_sector = s;
+        }
+    }
+    if (newest) {
+        log->next_free = (newest_sector + 1) % BREWLOG_SECTORS;
+        log->serial = newest->serial + 1;
+        log->run = newest->run + 1;
+    }
+    if (log->run == 0) log->run = 1;
+
+    while (log->erased_ahead < BREWLOG_SECTORS - 1 &&
+           sector_is_erased((log->next_free + log->erased_ahead) % BREWLOG_SECTORS)) {
+        log->erased_ahead++;
+    }
+}
+
+// --- Área de preparação (só RAM, chamada a partir do tick) ---
+
+// Fecha a página ativa (completando com 0xFF) e passa para a outra
+static void queue_active(brewlog_t* log) {
+    uint8_t a = log->active;
+    memset(&log->page[a][log->fill], 0xFF, BREWLOG_PAGE_SIZE - log->fill);
+    log->pending[a] = true;
+    log->active = !a;
+    log->fill = 0;
+    log->page_addr[log->active] = log->page_addr[a] + BREWLOG_PAGE_SIZE;
+}
+
+static void stage_bytes(brewlog_t* log, const uint8_t* data, uint16_t len) {
+    for (uint16_t i = 0; i < len; i++) {
+        if (log->fill == BREWLOG_PAGE_SIZE) queue_active(log);
+        log->page[log->active][log->fill++] = data[i];
+    }
+    log->sector_used += len;
+}
+
+// Abre o próximo setor do anel, já apagado, na página ativa (vazia) e zera
+// os deltas. Sem setor pronto não abre: com panelas em execução a flash
+// nunca é apagada.
+static bool open_sector(brewlog_t* log, uint8_t vessels) {
+    if (log->erased_ahead == 0) {
+        log->sector_used = BREWLOG_SECTOR_SIZE; // Tenta de novo no próximo registro
+        return false;
+    }
+    uint8_t a = log->active;
+    log->sector = log->next_free;
+    log->next_free = (log->next_free + 1) % BREWLOG_SECTORS;
+    log->erased_ahead--;
+    log->page_addr[a] = (uint32_t)log->sector * BREWLOG_SECTOR_SIZE;
+    log->sector_used = 0;
+
+    brewlog_sector_t h = {
+        .magic = BREWLOG_MAGIC,
+        .serial = log->serial++,
+        .run = log->run,
+        .index = log->run_index++,
+        .period_ms = (uint16_t)log->period_ms,
+        .vessels = vessels,
+        .version = BREWLOG_VERSION,
+    };
+    stage_bytes(log, (const uint8_t*)&h, sizeof(h));
+
+    log->last_t = 0;
+    memset(log->last_temp, 0, sizeof(log->last_temp));
+    memset(log->last_setpoint, 0, sizeof(log->last_setpoint));
+    memset(log->last_angle, 0, sizeof(log->last_angle));
+    memset(log->last_state, 0, sizeof(log->last_state));
+    return true;
+}
+
+// Garante espaço para um registro de até len bytes sem esperar pela flash.
+// Um registro nunca atravessa o fim do setor.
+static bool reserve(brewlog_t* log, uint8_t vessels, uint16_t len) {
+    bool other_free = !log->pending[!log->active];
+    if (log->sector_used + len > BREWLOG_SECTOR_SIZE) {
+        if (log->fill) {
+            if (!other_free) return false;
+            queue_active(log);
+        }
+        return open_sector(log, vessels);
+    }
+    return BREWLOG_PAGE_SIZE - log->fill >= len || other_free;
+}
+
+static uint8_t put_varint(uint8_t* out, uint32_t x) {
+    uint8_t n = 0;
+    while (x >= 0x80) {
+        out[n++] = (uint8_t)(x | 0x80);
+        x >>= 7;
+    }
+    out[n++] = (uint8_t)x;
+    return n;
+}
+
+static uint32_t zigzag(int32_t d) {
+    return ((uint32_t)d << 1) ^ (uint32_t)(d >> 31);
+}
+
+static void emit_sample(brewlog_t* log, const vessels_t* v, uint8_t i, uint32_t t) {
+    if (!reserve(log, v->count, BREWLOG_RECORD_MAX)) {
+        log->lost++;
+        log->dropped++;
+        if (log->erased_ahead == 0 && log->sector_used == BREWLOG_SECTOR_SIZE) log->starved++;
+        return;
+    }
+
+    int16_t temp = (int16_t)(v->temperature[i] * 16.0f); // 1/16 °C, como o DS18B20
+    int16_t setpoint = 0;
+    uint8_t state = BREWLOG_S_STAGE;
+    if (vessel_running(v, i)) {
+        const brassagem_stage_t* stage = vessel_current_stage(v, i);
+        setpoint = (int16_t)((stage->temp_min + stage->temp_max) * 8.0f); // Meio da janela
+        state = v->stage[i] < BREWLOG_S_STAGE ? v->stage[i] : BREWLOG_S_STAGE - 1;
+    }
+    if (v->flame_active[i]) state |= BREWLOG_S_FLAME;
+    if (v->timer_active[i]) state |= BREWLOG_S_TIMER;
+    if (v->timer_finished[i]) state |= BREWLOG_S_FINISHED;
+    if (v->sensor[i] >= 0 && v->measured_ok[i]) state |= BREWLOG_S_SENSOR;
+
+    uint8_t buf[BREWLOG_RECORD_MAX];
+    uint8_t n = 1, fields = 0;
+    n += put_varint(&buf[n], t - log->last_t);
+    if (temp != log->last_temp[i]) {
+        fields |= BREWLOG_F_TEMP;
+        n += put_varint(&buf[n], zigzag(temp - log->last_temp[i]));
+    }
+    if (setpoint != log->last_setpoint[i]) {
+        fields |= BREWLOG_F_SETPOINT;
+        n += put_varint(&buf[n], zigzag(setpoint - log->last_setpoint[i]));
+    }
+    if (v->servo_angle[i] != log->last_angle[i]) {
+        fields |= BREWLOG_F_ANGLE;
+        n += put_varint(&buf[n], zigzag(v->servo_angle[i] - log->last_angle[i]));
+    }
+    if (state != log->last_state[i]) {
+        fields |= BREWLOG_F_STATE;
+        buf[n++] = state;
+    }
+    buf[0] = (uint8_t)(fields << 2) | i;
+
+    log->last_t = t;
+    log->last_temp[i] = temp;
+    log->last_setpoint[i] = setpoint;
+    log->last_angle[i] = v->servo_angle[i];
+    log->last_state[i] = state;
+    stage_bytes(log, buf, n);
+    log->records++;
+}
+
+static bool emit_marker(brewlog_t* log, uint8_t vessels, uint8_t tag, uint32_t value) {
+    if (!reserve(log, vessels, 1 + 5)) return false;
+    uint8_t buf[1 + 5];
+    buf[0] = tag;
+    uint8_t n = 1 + put_varint(&buf[1], value);
+    stage_bytes(log, buf, n);
+    return true;
+}
+
+static bool begin_run(brewlog_t* log, uint8_t vessels, uint32_t now_ms) {
+    // A última página da corrida anterior ainda não saiu da RAM
+    if (log->closing) {
+        if (log->fill && log->pending[!log->active]) return false;
+        if (log->fill) queue_active(log);
+        log->closing = false;
+    }
+    log->run_index = 0;
+    log->run_start_ms = now_ms;
+    log->last_sample_ms = now_ms - log->period_ms;
+    log->lost = 0;
+    if (!open_sector(log, vessels)) printf("brewlog: nenhum setor apagado, corrida %u sem registro\n", log->run);
+    log->logging = true;
+    return true;
+}
+
+static void end_run(brewlog_t* log, uint8_t vessels, uint32_t t) {
+    if (emit_marker(log, vessels, BREWLOG_TAG_END, t - log->last_t)) {
+        log->last_t = t;
+    } else {
+        log->dropped++;
+    }
+    log->logging = false;
+    log->closing = true;
+    if (++log->run == 0) log->run = 1;
+}
+
+void brewlog_tick(brewlog_t* log, const vessels_t* v, uint32_t now_ms) {
+    if (!log->enabled) return;
+
+    bool any_running = vessels_any_running(v);
+
+    if (!log->logging && (!any_running || !begin_run(log, v->count, now_ms))) return;
+
+    uint32_t t = (now_ms - log->run_start_ms) / BREWLOG_TIME_UNIT_MS;
+    if (!any_running) {
+        end_run(log, v->count, t);
+        return;
+    }
+    if (now_ms - log->last_sample_ms < log->period_ms) return;
+    log->last_sample_ms = now_ms;
+
+    if (log->lost && emit_marker(log, v->count, BREWLOG_TAG_LOST, log->lost)) log->lost = 0;
+    for (uint8_t i = 0; i < v->count; i++) emit_sample(log, v, i, t);
+}
+
+// --- Flash e exportação (fora do tick) ---
+
+#if LIB_PICO_STDIO_USB
+// Durante a exportação o printf não vai para a USB, para não se misturar
+// ao fluxo binário (continua na UART)
+static void end_export(brewlog_t* log) {
+    log->export_left = 0;
+    stdio_set_driver_enabled(&stdio_usb, true);
+}
+#endif
+
+void brewlog_service(brewlog_t* log, absolute_time_t deadline) {
+    if (!log->enabled) return;
+
+    uint8_t p = !log->active;
+    if (log->pending[p]) {
+        if (slack_us(deadline) < BREWLOG_PROGRAM_US) return;
+        program_page(log, p);
+    }
+
+    if (!log->pending[p]) {
+        if (log->fill == BREWLOG_PAGE_SIZE) {
+            queue_active(log);
+        } else if (log->closing) {
+            if (log->fill) queue_active(log);
+            log->closing = false;
+        } else if (!log->logging && log->export_left == 0 && log->erased_ahead < BREWLOG_ERASE_AHEAD &&
+                   time_reached(log->next_pre_erase) && slack_us(deadline) >= BREWLOG_ERASE_US) {
+            // Panelas paradas (válvulas fechadas): prepara o próximo setor do
+            // anel, no máximo um a cada BREWLOG_PRE_ERASE_MS
+            erase_sector(log, (log->next_free + log->erased_ahead) % BREWLOG_SECTORS);
+            log->erased_ahead++;
+            log->next_pre_erase = make_timeout_time_ms(BREWLOG_PRE_ERASE_MS);
+        }
+    }
+
+#if LIB_PICO_STDIO_USB
+    // Exportação: setores direto do XIP para a CDC, até a folga acabar. Cada
+    // escrita cabe no espaço livre do FIFO, então o driver nunca espera.
+    while (log->export_left && slack_us(deadline) > BREWLOG_EXPORT_CHUNK_US) {
+        if (!stdio_usb_connected()) {
+            end_export(log);
+            break;
+        }
+        uint32_t room = tud_cdc_write_available();
+        if (room == 0) break;
+        uint32_t n = BREWLOG_SECTOR_SIZE - log->export_pos;
+        if (n > room) n = room;
+        stdio_usb.out_chars((const char*)sector_ptr(log->export_sector) + log->export_pos, (int)n);
+        log->export_pos += n;
+        if (log->export_pos == BREWLOG_SECTOR_SIZE) {
+            log->export_pos = 0;
+            log->export_sector = (log->export_sector + 1) % BREWLOG_SECTORS;
+            if (--log->export_left == 0) end_export(log);
+        }
+    }
+#endif
+}
+
+// --- Console ---
+
+// Corridas em ordem no anel, da mais antiga (logo após next_free) à atual.
+// Os setores de uma corrida são sempre consecutivos.
+static void list_runs(const brewlog_t* log) {
+    uint16_t run = 0, count = 0, first_index = 0;
+    for (uint16_t k = 0; k <= BREWLOG_SECTORS; k++) {
+        const brewlog_sector_t* h = k < BREWLOG_SECTORS ? sector_header((log->next_free + k) % BREWLOG_SECTORS) : NULL;
+        if (count && (!h || h->run != run)) {
+            printf("corrida %u: %u setores (%u KB)%s\n", run, count, count * (BREWLOG_SECTOR_SIZE / 1024),
+                   first_index ? ", inicio sobrescrito" : "");
+            count = 0;
+        }
+        if (h && count == 0) {
+            run = h->run;
+            first_index = h->index;
+        }
+        if (h) count++;
+    }
+    printf("%lu registros, %lu perdidos (%lu sem setor pronto), %lu paginas, %lu setores apagados, %u prontos\n",
+           log->records, log->dropped, log->starved, log->pages_written, log->sectors_erased,
+           log->erased_ahead);
+}
+
+static void start_export(brewlog_t* log, uint16_t run) {
+#if LIB_PICO_STDIO_USB
+    uint16_t first = 0, count = 0;
+    for (uint16_t k = 0; k < BREWLOG_SECTORS; k++) {
+        uint16_t s = (log->next_free + k) % BREWLOG_SECTORS;
+        const brewlog_sector_t* h = sector_header(s);
+        if (h && h->run == run) {
+            if (count == 0) first = s;
+            count++;
+        } else if (count) {
+            break;
+        }
+    }
+    if (count == 0) {
+        printf("corrida %u nao encontrada\n", run);
+        return;
+    }
+    printf("BREWLOG run=%u bytes=%lu\n", run, (uint32_t)count * BREWLOG_SECTOR_SIZE);
+    stdio_flush();
+    stdio_set_driver_enabled(&stdio_usb, false);
+    log->export_sector = first;
+    log->export_left = count;
+    log->export_pos = 0;
+#else
+    (void)log;
+    (void)run;
+    printf("exportacao requer stdio USB\n");
+#endif
+}
+
+static void run_command(brewlog_t* log, const char* cmd) {
+    unsigned long arg = strtoul(cmd + 1, NULL, 10);
+    switch (cmd[0]) {
+    case 'l':
+        list_runs(log);
+        break;
+    case 'e':
+        start_export(log, (uint16_t)arg);
+        break;
+    case 'p':
+        if (arg < BREWLOG_TIME_UNIT_MS) arg = BREWLOG_TIME_UNIT_MS;
+        if (arg > UINT16_MAX) arg = UINT16_MAX;
+        log->period_ms = arg;
+        printf("periodo %lu ms\n", log->period_ms);
+        break;
+    default:
+        printf("comandos: l | e <corrida> | p <ms>\n");
+        break;
+    }
+}
+
+void brewlog_poll_command(brewlog_t* log) {
+    int c;
+    while ((c = getchar_timeout_us(0)) != PICO_ERROR_TIMEOUT) {
+        if (c == '\r' || c == '\n') {
+            log->cmd[log->cmd_len] = '\0';
+            if (log->cmd_len) run_command(log, log->cmd);
+            log->cmd_len = 0;
+        } else if (log->cmd_len < sizeof(log->cmd) - 1) {
+            log->cmd[log->cmd_len++] = (char)c;
+        }
+    }
+}
@@ -0,0 +1,148 @@
+#ifndef BREWLOG_H
+#define BREWLOG_H
+
+#include "pico/stdlib.h"
+#include "vessel.h"
+
+// Registro das corridas de brassagem na flash livre do Pico W.
+//
+// Enquanto alguma panela estiver em execução, a cada BREWLOG_PERIOD_MS é
+// gravada uma amostra por panela (temperatura, setpoint, ângulo da válvula
+// e estado). As amostras são codificadas como deltas em varint em relação à
+// anterior da mesma panela e acumuladas numa área de preparação dupla de
+// duas páginas na RAM. O tick de controle só copia bytes para a página
+// ativa; a programação da flash acontece em brewlog_service(), na folga
+// antes do próximo tick. Os setores só são apagados com as panelas paradas
+// (válvulas fechadas), com antecedência, no máximo um por
+// BREWLOG_PRE_ERASE_MS e só se o apagamento típico couber na folga do tick:
+// um apagamento mascara as interrupções por até BREWLOG_ERASE_MAX_US, o
+// que não cabe no limite de reação do intertravamento (safety.h). Durante
+// uma corrida só se programam páginas; se os setores prontos acabarem, as
+// amostras seguintes são contadas como perdidas.
+//
+// Formato na flash: um anel de setores de 4 KB. Cada setor começa com um
+// brewlog_sector_t e a base dos deltas é zerada a cada setor, de modo que
+// qualquer setor é decodificável sozinho. Cada corrida começa num setor novo.
+//   amostra:  tag (bits 0-1 panela, bits 2-5 campos presentes), dt e os
+//             deltas dos campos presentes em zigzag varint
+//   0x80:     fim da corrida (dt)
+//   0x81:     registros perdidos por falta de espaço na RAM (contagem)
+//   0xFF:     fim dos dados do setor (flash apagada)
+// O decodificador de referência é tools/brewlog_dump.py.
+
+#ifndef BREWLOG_FLASH_BYTES
+#define BREWLOG_FLASH_BYTES (1536u * 1024u) // Fim da flash de 2 MB do Pico W
+#endif
+#ifndef BREWLOG_PERIOD_MS
+#define BREWLOG_PERIOD_MS   1000
+#endif
+#define BREWLOG_PAGE_SIZE   256   // FLASH_PAGE_SIZE
+#define BREWLOG_SECTOR_SIZE 4096  // FLASH_SECTOR_SIZE
+#define BREWLOG_SECTORS     (BREWLOG_FLASH_BYTES / BREWLOG_SECTOR_SIZE)
+#ifndef BREWLOG_ERASE_AHEAD
+#define BREWLOG_ERASE_AHEAD 128   // Setores apagados à frente (512 KB, ~9 h com 4 panelas)
+#endif
+#define BREWLOG_ERASE_US    45000 // Apagamento típico de um setor (W25Q16JV)
+#define BREWLOG_ERASE_MAX_US 400000 // Pior caso do apagamento pela folha de dados
+#define BREWLOG_IRQ_OFF_MAX_US 3000 // Pior caso de uma página (tPP), o que se grava em corrida
+#define BREWLOG_PRE_ERASE_MS 250  // Intervalo mínimo entre pré-apagamentos (1 a cada 5 ticks)
+#define BREWLOG_TIME_UNIT_MS 10   // Resolução do tempo nos registros
+#define BREWLOG_RECORD_MAX  16   // tag + dt + 3 deltas de 16 bits + estado
+#define BREWLOG_MAGIC       0x474F4C42u // "BLOG"
+#define BREWLOG_VERSION     1
+
+// Campos presentes numa amostra (bits 2-5 da tag)
+#define BREWLOG_F_TEMP     0x01
+#define BREWLOG_F_SETPOINT 0x02
+#define BREWLOG_F_ANGLE    0x04
+#define BREWLOG_F_STATE    0x08
+
+#define BREWLOG_TAG_END    0x80
+#define BREWLOG_TAG_LOST   0x81
+
+// Bits do campo de estado
+#define BREWLOG_S_STAGE    0x07 // Índice do estágio, 7 = parada
+#define BREWLOG_S_FLAME    0x08
+#define BREWLOG_S_TIMER    0x10
+#define BREWLOG_S_FINISHED 0x20
+#define BREWLOG_S_SENSOR   0x40
+
+typedef struct {
+    uint32_t magic;
+    uint32_t serial;    // Contador global de setores abertos (ordem no anel)
+    uint16_t run;       // Número da corrida
+    uint16_t index;     // Setor dentro da corrida (0 = início)
+    uint16_t period_ms;
+    uint8_t vessels;
+    uint8_t version;
+} brewlog_sector_t;
+
+typedef struct {
+    bool enabled;       // false se a região colidir com o binário
+    uint32_t period_ms;
+
+    // Área de preparação dupla: uma página recebe registros enquanto a
+    // outra espera pela programação da flash
+    uint8_t page[2][BREWLOG_PAGE_SIZE];
+    uint32_t page_addr[2];     // Offset de cada página na região
+    bool pending[2];
+    uint8_t active;
+    uint16_t fill;
+
+    // Posição no anel
+    uint16_t sector;           // Setor sendo preenchido
+    uint16_t next_free;        // Próximo setor a abrir
+    uint16_t erased_ahead;     // Setores apagados a partir de next_free
+    absolute_time_t next_pre_erase;
+    uint16_t sector_used;      // Bytes já preparados no setor atual
+    uint32_t serial;
+
+    // Corrida atual
+    bool logging;
+    bool closing;              // Fim da corrida aguardando a última página
+    uint16_t run;
+    uint16_t run_index;
+    uint32_t run_start_ms;
+    uint32_t last_sample_ms;
+    uint32_t last_t;           // Base do tempo (em BREWLOG_TIME_UNIT_MS)
+    int16_t last_temp[VESSEL_MAX];
+    int16_t last_setpoint[VESSEL_MAX];
+    uint8_t last_angle[VESSEL_MAX];
+    uint8_t last_state[VESSEL_MAX];
+    uint32_t lost;             // Perdidos desde o último marcador 0x81
+
+    // Exportação pela USB
+    uint16_t export_sector;
+    uint16_t export_left;
+    uint16_t export_pos;
+
+    // Console serial
+    char cmd[16];
+    uint8_t cmd_len;
+
+    // Estatísticas
+    uint32_t records;
+    uint32_t dropped;
+    uint32_t pages_written;
+    uint32_t sectors_erased;
+    uint32_t starved;          // Registros perdidos sem setor pré-apagado
+} brewlog_t;
+
+// Localiza o fim do anel na flash e a próxima corrida
+void brewlog_init(brewlog_t* log);
+
+// Chamado a cada tick de controle: abre/fecha corridas conforme as panelas
+// entram/saem de execução e grava uma amostra por panela a cada período.
+// Nunca acessa a flash.
+void brewlog_tick(brewlog_t* log, const vessels_t* v, uint32_t now_ms);
+
+// Trabalho de flash e exportação que cabe até deadline (o próximo tick)
+void brewlog_service(brewlog_t* log, absolute_time_t deadline);
+
+// Console na serial, sem bloquear:
+//   l        lista as corridas no anel e as estatísticas
+//   e <n>    exporta a corrida n (cabeçalho em texto + setores brutos)
+//   p <ms>   muda o período de amostragem
+void brewlog_poll_command(brewlog_t* log);
+
+#endif
@@ -0,0 +1,61 @@
+#include "control.h"
+#include "hot_path.h"
+
+// Controle proporcional da chama a partir da temperatura já atualizada
+static uint8_t HOT_PATH(control_output)(float temperature, bool flame_active,
+                              const brassagem_stage_t* stage, uint16_t* led_intensity) {
+    float temp_range = stage->temp_max - stage->temp_min;
+    float temp_progress = (temperature - stage->temp_min) / temp_range;
+    if (temp_progress < 0) temp_progress = 0;
+    if (temp_progress > 1) temp_progress = 1;
+
+    if (flame_active) {
+        *led_intensity = (uint16_t)(4095 * (1 - temp_progress));
+        return (uint8_t)(90 * (1 - temp_progress));
+    }
+    *led_intensity = 0;
+    return 0;
+}
+
+uint8_t HOT_PATH(control_step)(float* temperature, float* last_temperature, bool* flame_active,
+                     const brassagem_stage_t* stage, int16_t y_adjust, uint16_t* led_intensity) {
+    // Ajusta a temperatura com base no movimento do joystick
+    *temperature += ((float)y_adjust / 4095.0f) * 0.5f;
+
+    if (*temperature < 0.0f) *temperature = 0.0f;
+    if (*temperature > stage->temp_max) *temperature = stage->temp_max;
+
+    // Verifica se a temperatura caiu em relação ao ciclo anterior
+    if (*temperature < *last_temperature) {
+        *flame_active = true;
+    } else if (*temperature >= stage->temp_max) {
+        *flame_active = false;
+    }
+
+    uint8_t servo_angle = control_output(*temperature, *flame_active, stage, led_intensity);
+    if (*flame_active) {
+        *temperature += 0.1f; // Aumenta a temperatura enquanto a chama está ativa
+    }
+
+    // Atualiza a temperatura anterior para o próximo ciclo
+    *last_temperature = *temperature;
+    return servo_angle;
+}
+
+uint8_t HOT_PATH(control_step_measured)(float measured, float* temperature, float* last_temperature,
+                              bool* flame_active, const brassagem_stage_t* stage,
+                              uint16_t* led_intensity) {
+    *temperature = measured;
+
+    // Mesma histerese da simulação: acende quando esfria ou abaixo da
+    // janela, apaga ao atingir o máximo do estágio
+    if (measured < *last_temperature || measured < stage->temp_min) {
+        *flame_active = true;
+    }
+    if (measured >= stage->temp_max) {
+        *flame_active = false;
+    }
+
+    *last_temperature = measured;
+    return control_output(measured, *flame_active, stage, led_intensity);
+}
@@ -0,0 +1,27 @@
+#ifndef CONTROL_H
+#define CONTROL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Estrutura para estágios de brassagem
+typedef struct {
+    float temp_min;
+    float temp_max;
+    const char* nome;
+    uint32_t duration;
+} brassagem_stage_t;
+
+// Passo puro do controle de temperatura (sem ADC nem PWM).
+// Recebe o desvio já filtrado do joystick e devolve o ângulo da válvula;
+// a intensidade do LED vermelho é escrita em *led_intensity.
+uint8_t control_step(float* temperature, float* last_temperature, bool* flame_active,
+                     const brassagem_stage_t* stage, int16_t y_adjust, uint16_t* led_intensity);
+
+// Mesmo controle, com a temperatura vinda de um sensor real em vez de
+// integrada a partir do joystick
+uint8_t control_step_measured(float measured, float* temperature, float* last_temperature,
+                              bool* flame_active, const brassagem_stage_t* stage,
+                              uint16_t* led_intensity);
+
+#endif
@@ -0,0 +1,37 @@
+#include "ds18b20.h"
+#include "hot_path.h"
+
+// Partes comuns aos backends PIO (ds18b20_pio.c) e simulado (ds18b20_sim.c)
+
+uint8_t HOT_PATH(ds18b20_crc8)(const uint8_t* data, size_t len) {
+    uint8_t crc = 0;
+    while (len--) {
+        uint8_t byte = *data++;
+        for (int i = 0; i < 8; i++) {
+            uint8_t mix = (crc ^ byte) & 0x01;
+            crc >>= 1;
+            if (mix) crc ^= 0x8C;
+            byte >>= 1;
+        }
+    }
+    return crc;
+}
+
+void HOT_PATH(ds18b20_publish)(ds18b20_bus_t* bus, uint8_t probe, int16_t raw, uint32_t now_ms) {
+    uint16_t seq = (uint16_t)((bus->sample[probe] >> 16) + 1);
+    if (seq == 0) seq = 1; // 0 indica "nunca publicada"
+    bus->sample_ms[probe] = now_ms;
+    bus->sample[probe] = ((uint32_t)seq << 16) | (uint16_t)raw;
+}
+
+bool ds18b20_read(const ds18b20_bus_t* bus, uint8_t probe, uint32_t now_ms,
+                  uint32_t max_age_ms, float* temp_c) {
+    if (probe >= bus->probe_count) return false;
+    uint32_t stamp = bus->sample_ms[probe];
+    uint32_t s = bus->sample[probe];
+    if ((s >> 16) == 0) return false;
+    if (now_ms - stamp > max_age_ms) return false;
+    *temp_c = (int16_t)(s & 0xFFFF) / 16.0f;
+    return true;
+}
+
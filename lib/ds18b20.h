@@ -0,0 +1,81 @@
+#ifndef DS18B20_H
+#define DS18B20_H
+
+#include "pico/stdlib.h"
+#include "hardware/pio.h"
+
+#define DS18B20_MAX_PROBES    4
+#define DS18B20_CONVERSION_MS 750  // Resolução de 12 bits
+#define DS18B20_POLL_US       1000 // Período do serviço do barramento
+#define DS18B20_XFER_MAX      20   // MATCH ROM + 8 bytes de ROM + READ + 9 bytes
+#define DS18B20_NO_PROBE      DS18B20_MAX_PROBES // Canal de uma sonda ausente: nunca tem leitura
+#define DS18B20_RESCAN_CYCLES 10   // Conversões entre buscas por sondas novas ou trocadas
+
+// Barramento 1-Wire com até DS18B20_MAX_PROBES sondas. Todo o protocolo
+// (busca de ROM, conversão em broadcast e leitura do scratchpad de cada
+// sonda) avança em passos curtos num timer de DS18B20_POLL_US, só lendo e
+// escrevendo os FIFOs do PIO. O laço principal apenas consulta a última
+// leitura publicada, sem nunca esperar pelo barramento.
+//
+// Os canais seguem a ordem da busca, que muda quando uma sonda entra ou sai
+// do barramento. A busca se repete a cada DS18B20_RESCAN_CYCLES conversões,
+// mesmo com o barramento saudável, para achar uma sonda ligada ou trocada
+// com as outras respondendo. Quando o resultado difere de rom[], searches
+// avança, as leituras da busca anterior são descartadas e quem usa os
+// canais os reassocia pela ROM (probe_map.h).
+typedef struct {
+    PIO pio;
+    uint sm;
+    uint offset;
+    repeating_timer_t timer;
+
+    uint8_t probe_count;
+    uint8_t rom[DS18B20_MAX_PROBES][8];
+    volatile uint16_t searches;        // Buscas que mudaram rom[]; rom[] estável entre elas
+
+    // Leituras publicadas (escritor único: o timer do barramento)
+    volatile uint32_t sample[DS18B20_MAX_PROBES];    // (seq << 16) | bruto em 1/16 °C
+    volatile uint32_t sample_ms[DS18B20_MAX_PROBES]; // Instante da leitura (ms desde o boot)
+    volatile uint32_t errors;                        // Sem presença ou CRC inválido
+
+    // Máquina de estados do barramento
+    uint8_t state;
+    uint8_t phase;
+    uint8_t probe;
+    uint32_t convert_start_ms;
+    uint8_t tx[DS18B20_XFER_MAX];
+    uint8_t rx[DS18B20_XFER_MAX];
+    uint8_t len, tx_pos, rx_pos;
+
+    // Busca de ROM (Maxim AN187), um bit por vez, em found[] até terminar
+    uint8_t found_count;
+    uint8_t found[DS18B20_MAX_PROBES][8];
+    uint8_t cycles;                    // Conversões desde a última busca
+    uint8_t search_rom[8];
+    uint8_t search_bit;
+    uint8_t search_step;
+    uint8_t last_discrepancy;
+    uint8_t last_zero;
+    bool last_device;
+} ds18b20_bus_t;
+
+// Configura o PIO (state machine livre) e inicia o serviço em segundo plano
+void ds18b20_init(ds18b20_bus_t* bus, PIO pio, uint pin);
+
+// Última leitura da sonda. Retorna false se não houver leitura ou se ela
+// for mais velha que max_age_ms.
+bool ds18b20_read(const ds18b20_bus_t* bus, uint8_t probe, uint32_t now_ms,
+                  uint32_t max_age_ms, float* temp_c);
+
+#ifdef U7T_DS18B20_SIM
+// Backend simulado: informa a abertura da válvula que aquece a panela
+// medida pela sonda, para o modelo térmico.
+void ds18b20_sim_set_heat(ds18b20_bus_t* bus, uint8_t probe, uint8_t servo_angle);
+#endif
+
+uint8_t ds18b20_crc8(const uint8_t* data, size_t len);
+
+// Uso dos backends: publica uma leitura bruta (1/16 °C) da sonda
+void ds18b20_publish(ds18b20_bus_t* bus, uint8_t probe, int16_t raw, uint32_t now_ms);
+
+#endif
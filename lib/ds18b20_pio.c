@@ -0,0 +1,280 @@
+#include "ds18b20.h"
+#include "onewire.pio.h"
+#include "hot_path.h"
+
+#define OW_SKIP_ROM    0xCC
+#define OW_MATCH_ROM   0x55
+#define OW_SEARCH_ROM  0xF0
+#define DS_CONVERT_T   0x44
+#define DS_READ_SCRATCH 0xBE
+#define DS_RETRY_MS    1000 // Espera antes de refazer a busca sem sondas
+
+// Estados do ciclo do barramento
+enum { ST_SEARCH, ST_SEARCH_BITS, ST_CONVERT, ST_CONVERTING, ST_READ, ST_RETRY };
+// Fases de uma transação (reset + bytes)
+enum { PH_NONE, PH_RESET, PH_XFER, PH_DONE, PH_FAIL };
+
+static void HOT_PATH(begin_transaction)(ds18b20_bus_t* bus, uint8_t len) {
+    bus->len = len;
+    bus->tx_pos = 0;
+    bus->rx_pos = 0;
+    bus->phase = PH_RESET;
+    onewire_program_reset(bus->pio, bus->sm, bus->offset);
+}
+
+// Avança a transação corrente só com o que já está nos FIFOs
+static void HOT_PATH(service_transaction)(ds18b20_bus_t* bus) {
+    if (bus->phase == PH_RESET) {
+        if (pio_sm_is_rx_fifo_empty(bus->pio, bus->sm)) return;
+        if (pio_sm_get(bus->pio, bus->sm) & 1u) { // Barramento em 1: ninguém respondeu
+            bus->phase = PH_FAIL;
+            return;
+        }
+        bus->phase = PH_XFER;
+    }
+    if (bus->phase != PH_XFER) return;
+
+    while (bus->rx_pos < bus->len && !pio_sm_is_rx_fifo_empty(bus->pio, bus->sm)) {
+        bus->rx[bus->rx_pos++] = (uint8_t)(pio_sm_get(bus->pio, bus->sm) >> 24);
+    }
+    while (bus->tx_pos < bus->len && !pio_sm_is_tx_fifo_full(bus->pio, bus->sm)) {
+        pio_sm_put(bus->pio, bus->sm, bus->tx[bus->tx_pos++]);
+    }
+    if (bus->rx_pos == bus->len) bus->phase = PH_DONE;
+}
+
+// Um bit da busca: lê bit e complemento, escolhe a direção e a escreve
+static bool HOT_PATH(search_step)(ds18b20_bus_t* bus) {
+    PIO pio = bus->pio;
+    uint sm = bus->sm;
+
+    if (bus->search_step == 0) {
+        pio_sm_put(pio, sm, 1);
+        pio_sm_put(pio, sm, 1);
+        bus->search_step = 1;
+        return true;
+    }
+    if (bus->search_step == 1) {
+        if (pio_sm_get_rx_fifo_level(pio, sm) < 2) return false;
+        uint id = pio_sm_get(pio, sm) >> 31;
+        uint cmp = pio_sm_get(pio, sm) >> 31;
+        uint n = bus->search_bit + 1;
+        uint8_t mask = 1u << (bus->search_bit & 7);
+        uint8_t* byte = &bus->search_rom[bus->search_bit >> 3];
+        uint dir;
+
+        if (id && cmp) { // Nenhum dispositivo respondeu
+            bus->phase = PH_FAIL;
+            return false;
+        }
+        if (id != cmp) {
+            dir = id;
+        } else {
+            dir = (n < bus->last_discrepancy) ? ((*byte & mask) != 0) : (n == bus->last_discrepancy);
+            if (!dir) bus->last_zero = n;
+        }
+        if (dir) *byte |= mask; else *byte &= ~mask;
+
+        pio_sm_put(pio, sm, dir);
+        bus->search_step = 2;
+        return true;
+    }
+    if (pio_sm_is_rx_fifo_empty(pio, sm)) return false;
+    pio_sm_get(pio, sm);
+    bus->search_step = 0;
+    if (++bus->search_bit == 64) bus->phase = PH_DONE;
+    return bus->phase != PH_DONE;
+}
+
+static void begin_search(ds18b20_bus_t* bus) {
+    bus->found_count = 0;
+    bus->last_discrepancy = 0;
+    bus->last_device = false;
+    bus->phase = PH_NONE;
+    bus->state = ST_SEARCH;
+}
+
+// Adota o resultado da busca. Os canais só mudam se o conjunto ou a ordem
+// das sondas mudou; uma busca que acha as mesmas sondas não interrompe as
+// leituras.
+static void commit_search(ds18b20_bus_t* bus) {
+    bool same = bus->found_count == bus->probe_count;
+    for (int p = 0; same && p < bus->found_count; p++) {
+        for (int i = 0; i < 8; i++) same = same && bus->found[p][i] == bus->rom[p][i];
+    }
+    if (!same) {
+        for (int p = 0; p < bus->found_count; p++) {
+            for (int i = 0; i < 8; i++) bus->rom[p][i] = bus->found[p][i];
+        }
+        bus->probe_count = bus->found_count;
+        // Um canal pode ter passado para outra sonda
+        for (int i = 0; i < DS18B20_MAX_PROBES; i++) bus->sample[i] = 0;
+        bus->searches++;
+    }
+    bus->cycles = 0;
+    bus->phase = PH_NONE;
+    bus->state = ST_CONVERT;
+}
+
+static void finish_search(ds18b20_bus_t* bus) {
+    onewire_program_set_bits(bus->pio, bus->sm, bus->offset, 8);
+    bus->phase = PH_NONE;
+
+    if (ds18b20_crc8(bus->search_rom, 7) == bus->search_rom[7] && bus->found_count < DS18B20_MAX_PROBES) {
+        for (int i = 0; i < 8; i++) bus->found[bus->found_count][i] = bus->search_rom[i];
+        bus->found_count++;
+    } else {
+        bus->errors++;
+    }
+
+    bus->last_discrepancy = bus->last_zero;
+    bus->last_device = (bus->last_zero == 0);
+    if (bus->last_device || bus->found_count == DS18B20_MAX_PROBES) {
+        commit_search(bus);
+    } else {
+        bus->state = ST_SEARCH;
+    }
+}
+
+static void restart_search(ds18b20_bus_t* bus, uint32_t now_ms) {
+    onewire_program_set_bits(bus->pio, bus->sm, bus->offset, 8);
+    bus->probe_count = 0;
+    bus->found_count = 0;
+    bus->last_discrepancy = 0;
+    bus->last_device = false;
+    bus->convert_start_ms = now_ms;
+    // Na próxima busca os canais podem mudar de sonda
+    for (int i = 0; i < DS18B20_MAX_PROBES; i++) bus->sample[i] = 0;
+    bus->phase = PH_NONE;
+    bus->state = ST_RETRY;
+}
+
+static bool HOT_PATH(ds18b20_timer_cb)(repeating_timer_t* rt) {
+    ds18b20_bus_t* bus = (ds18b20_bus_t*)rt->user_data;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+
+    switch (bus->state) {
+        case ST_SEARCH:
+            if (bus->phase == PH_NONE) {
+                bus->tx[0] = OW_SEARCH_ROM;
+                bus->last_zero = 0;
+                begin_transaction(bus, 1);
+            }
+            service_transaction(bus);
+            if (bus->phase == PH_DONE) {
+                onewire_program_set_bits(bus->pio, bus->sm, bus->offset, 1);
+                bus->search_bit = 0;
+                bus->search_step = 0;
+                bus->phase = PH_XFER;
+                bus->state = ST_SEARCH_BITS;
+            } else if (bus->phase == PH_FAIL) {
+                if (bus->found_count) {
+                    commit_search(bus);
+                } else {
+                    restart_search(bus, now_ms);
+                }
+            }
+            break;
+
+        case ST_SEARCH_BITS:
+            while (search_step(bus)) {
+            }
+            if (bus->phase == PH_DONE) {
+                finish_search(bus);
+            } else if (bus->phase == PH_FAIL) {
+                bus->errors++;
+                if (bus->probe_count) {
+                    // Busca periódica falhou: segue com as sondas conhecidas
+                    onewire_program_set_bits(bus->pio, bus->sm, bus->offset, 8);
+                    bus->cycles = 0;
+                    bus->phase = PH_NONE;
+                    bus->state = ST_CONVERT;
+                } else {
+                    restart_search(bus, now_ms);
+                }
+            }
+            break;
+
+        case ST_CONVERT:
+            // Conversão em broadcast: todas as sondas convertem em paralelo
+            if (bus->phase == PH_NONE) {
+                bus->tx[0] = OW_SKIP_ROM;
+                bus->tx[1] = DS_CONVERT_T;
+                begin_transaction(bus, 2);
+            }
+            service_transaction(bus);
+            if (bus->phase == PH_DONE) {
+                bus->convert_start_ms = now_ms;
+                bus->phase = PH_NONE;
+                bus->state = ST_CONVERTING;
+            } else if (bus->phase == PH_FAIL) {
+                bus->errors++;
+                restart_search(bus, now_ms);
+            }
+            break;
+
+        case ST_CONVERTING:
+            if (now_ms - bus->convert_start_ms >= DS18B20_CONVERSION_MS) {
+                bus->probe = 0;
+                bus->state = ST_READ;
+            }
+            break;
+
+        case ST_READ:
+            if (bus->phase == PH_NONE) {
+                uint8_t n = 0;
+                bus->tx[n++] = OW_MATCH_ROM;
+                for (int i = 0; i < 8; i++) bus->tx[n++] = bus->rom[bus->probe][i];
+                bus->tx[n++] = DS_READ_SCRATCH;
+                for (int i = 0; i < 9; i++) bus->tx[n++] = 0xFF;
+                begin_transaction(bus, n);
+            }
+            service_transaction(bus);
+            if (bus->phase == PH_DONE || bus->phase == PH_FAIL) {
+                const uint8_t* scratch = &bus->rx[10];
+                // O registrador de configuração tem os 5 bits baixos sempre em 1
+                if (bus->phase == PH_DONE && ds18b20_crc8(scratch, 8) == scratch[8] &&
+                    (scratch[4] & 0x1F) == 0x1F) {
+                    ds18b20_publish(bus, bus->probe, (int16_t)((scratch[1] << 8) | scratch[0]), now_ms);
+                } else {
+                    bus->errors++;
+                }
+                bus->phase = PH_NONE;
+                if (++bus->probe >= bus->probe_count) {
+                    // De tempos em tempos refaz a busca: acha sondas ligadas
+                    // ou trocadas sem esperar uma falha de presença
+                    if (++bus->cycles >= DS18B20_RESCAN_CYCLES) {
+                        begin_search(bus);
+                    } else {
+                        bus->state = ST_CONVERT;
+                    }
+                }
+            }
+            break;
+
+        case ST_RETRY:
+            if (now_ms - bus->convert_start_ms >= DS_RETRY_MS) begin_search(bus);
+            break;
+    }
+    return true;
+}
+
+void ds18b20_init(ds18b20_bus_t* bus, PIO pio, uint pin) {
+    bus->pio = pio;
+    bus->sm = pio_claim_unused_sm(pio, true);
+    bus->offset = pio_add_program(pio, &onewire_program);
+    onewire_program_init(pio, bus->sm, bus->offset, pin);
+
+    bus->probe_count = 0;
+    bus->searches = 0;
+    bus->errors = 0;
+    bus->cycles = 0;
+    begin_search(bus);
+    for (int i = 0; i < DS18B20_MAX_PROBES; i++) {
+        bus->sample[i] = 0;
+        bus->sample_ms[i] = 0;
+    }
+
+    add_repeating_timer_us(-DS18B20_POLL_US, ds18b20_timer_cb, bus, &bus->timer);
+}
+
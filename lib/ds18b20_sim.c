@@ -0,0 +1,65 @@
+#include "ds18b20.h"
+#include "vessel.h"
+#include "hot_path.h"
+
+// Backend simulado do DS18B20: mesma API e mesma cadência de publicação do
+// barramento real, com um modelo térmico de primeira ordem por sonda.
+//   dT/dt = SIM_HEAT_RATE * abertura - SIM_LOSS_RATE * (T - SIM_AMBIENT)
+
+// Uma sonda por panela ativa
+#define DS18B20_SIM_PROBES VESSEL_COUNT
+_Static_assert(DS18B20_SIM_PROBES <= DS18B20_MAX_PROBES, "sondas simuladas demais");
+
+#define SIM_STEP_MS   10
+#define SIM_AMBIENT   20.0f
+#define SIM_HEAT_RATE 0.5f    // °C/s com a válvula em 90°
+#define SIM_LOSS_RATE 0.002f  // 1/s
+
+static float sim_temp[DS18B20_MAX_PROBES];
+static volatile uint8_t sim_angle[DS18B20_MAX_PROBES];
+
+static bool HOT_PATH(ds18b20_sim_timer_cb)(repeating_timer_t* rt) {
+    ds18b20_bus_t* bus = (ds18b20_bus_t*)rt->user_data;
+    uint32_t now_ms = to_ms_since_boot(get_absolute_time());
+    const float dt = SIM_STEP_MS / 1000.0f;
+
+    for (uint8_t i = 0; i < bus->probe_count; i++) {
+        float opening = sim_angle[i] / 90.0f;
+        sim_temp[i] += (SIM_HEAT_RATE * opening - SIM_LOSS_RATE * (sim_temp[i] - SIM_AMBIENT)) * dt;
+    }
+
+    // Publica como o barramento real: todas as sondas a cada conversão
+    if (now_ms - bus->convert_start_ms >= DS18B20_CONVERSION_MS) {
+        bus->convert_start_ms = now_ms;
+        for (uint8_t i = 0; i < bus->probe_count; i++) {
+            ds18b20_publish(bus, i, (int16_t)(sim_temp[i] * 16.0f), now_ms); // 12 bits
+        }
+    }
+    return true;
+}
+
+void ds18b20_init(ds18b20_bus_t* bus, PIO pio, uint pin) {
+    (void)pin;
+    bus->pio = pio;
+    bus->probe_count = DS18B20_SIM_PROBES;
+    bus->searches = 1; // ROMs fixas: a busca já está concluída
+    bus->errors = 0;
+    bus->convert_start_ms = to_ms_since_boot(get_absolute_time());
+
+    for (uint8_t i = 0; i < DS18B20_MAX_PROBES; i++) {
+        // ROM fictícia com família 0x28 (DS18B20) e CRC válido
+        uint8_t rom[8] = {0x28, 0x51, 0x37, i, 0x00, 0x00, 0x00, 0x00};
+        rom[7] = ds18b20_crc8(rom, 7);
+        for (int b = 0; b < 8; b++) bus->rom[i][b] = rom[b];
+        bus->sample[i] = 0;
+        bus->sample_ms[i] = 0;
+        sim_temp[i] = SIM_AMBIENT;
+        sim_angle[i] = 0;
+    }
+
+    add_repeating_timer_ms(-SIM_STEP_MS, ds18b20_sim_timer_cb, bus, &bus->timer);
+}
+
+void ds18b20_sim_set_heat(ds18b20_bus_t* bus, uint8_t probe, uint8_t servo_angle) {
+    if (probe < bus->probe_count) sim_angle[probe] = servo_angle;
+}
@@ -0,0 +1,30 @@
+#include "flame.h"
+
+static const uint8_t flame_frames[FLAME_FRAMES][5][5] = {
+    {{1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 0, 0}, {0, 0, 0, 0, 0}},
+    {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}, {0, 0, 0, 0, 0}},
+    {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {0, 1, 2, 1, 0}, {0, 0, 1, 0, 0}},
+    {{1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 1}, {1, 2, 3, 2, 0}, {0, 1, 0, 1, 0}}
+};
+
+void flame_encode_frame(uint32_t out[FLAME_PIXELS], uint8_t frame, uint8_t servo_angle) {
+    float brightness = (float)servo_angle / 90.0f;
+    if (brightness < 0.0f) brightness = 0.0f;
+    if (brightness > 1.0f) brightness = 1.0f;
+
+    for (int y = 0; y < 5; y++) {
+        for (int x = 0; x < 5; x++) {
+            uint8_t intensity = flame_frames[frame % FLAME_FRAMES][y][x];
+            uint8_t r = (intensity == 1) ? 64 : (intensity >= 2) ? 255 : 0;
+            uint8_t g = (intensity == 2) ? 64 : (intensity == 3) ? 128 : 0;
+            uint8_t b = 0;
+
+            r = (uint8_t)(r * brightness);
+            g = (uint8_t)(g * brightness);
+            b = (uint8_t)(b * brightness);
+
+            uint32_t grb = ((uint32_t)g << 16) | ((uint32_t)r << 8) | b;
+            *out++ = grb << 8u;
+        }
+    }
+}
@@ -0,0 +1,14 @@
+#ifndef FLAME_H
+#define FLAME_H
+
+#include <stdint.h>
+
+#define FLAME_FRAMES 4
+#define FLAME_FRAME_MS 100 // Quadros pelo relógio, não pelo tick do laço
+#define FLAME_PIXELS 25 // Matriz WS2812 5x5
+
+// Codifica um quadro da animação da chama em palavras GRB prontas para o
+// FIFO do PIO (já deslocadas 8 bits). O brilho acompanha o ângulo da válvula.
+void flame_encode_frame(uint32_t out[FLAME_PIXELS], uint8_t frame, uint8_t servo_angle);
+
+#endif
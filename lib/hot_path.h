@@ -0,0 +1,17 @@
+#ifndef HOT_PATH_H
+#define HOT_PATH_H
+
+// Caminho crítico (tick de controle, callbacks de interrupção e blitter de
+// glifos). No perfil U7T_RAM_HOT_PATHS essas funções e tabelas vão para a
+// SRAM e não pagam faltas na cache do XIP; fora dele (e no build nativo dos
+// benchmarks) os marcadores não mudam nada.
+#if defined(U7T_RAM_HOT_PATHS) && PICO_ON_DEVICE
+#include "pico.h"
+#define HOT_PATH(func) __not_in_flash_func(func)
+#define HOT_DATA       __not_in_flash("hot_data")
+#else
+#define HOT_PATH(func) func
+#define HOT_DATA
+#endif
+
+#endif
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include "i2c_bus.h"
+
+static void bus_setup(i2c_bus_t* bus) {
+    bus->actual_hz = i2c_init(bus->port, bus->hz);
+    bus->byte_ns = (uint32_t)(9000000000ull / bus->actual_hz); // 9e9 não cabe em 32 bits
+    gpio_set_function(bus->sda, GPIO_FUNC_I2C);
+    gpio_set_function(bus->scl, GPIO_FUNC_I2C);
+    gpio_pull_up(bus->sda);
+    gpio_pull_up(bus->scl);
+}
+
+void i2c_bus_init(i2c_bus_t* bus, i2c_inst_t* port, uint sda, uint scl, uint32_t hz, uint32_t min_hz) {
+    bus->port = port;
+    bus->sda = sda;
+    bus->scl = scl;
+    bus->hz = hz;
+    bus->max_hz = hz;
+    bus->min_hz = min_hz < hz ? min_hz : hz;
+    bus->fails_in_row = 0;
+    bus->clean_in_row = 0;
+    bus->transfers = 0;
+    bus->bytes = 0;
+    bus->naks = 0;
+    bus->timeouts = 0;
+    bus->recoveries = 0;
+    bus->fallbacks = 0;
+    bus->step_ups = 0;
+    bus->busy_us = 0;
+    bus_setup(bus);
+}
+
+// Linhas em dreno aberto por GPIO: nível baixo = saída em 0, alto = entrada
+// com o pull-up
+static inline void line_release(uint gpio) {
+    gpio_set_dir(gpio, GPIO_IN);
+}
+
+static inline void line_low(uint gpio) {
+    gpio_put(gpio, 0);
+    gpio_set_dir(gpio, GPIO_OUT);
+}
+
+void i2c_bus_recover(i2c_bus_t* bus) {
+    bus->recoveries++;
+    i2c_deinit(bus->port);
+    gpio_init(bus->sda);
+    gpio_init(bus->scl);
+    gpio_pull_up(bus->sda);
+    gpio_pull_up(bus->scl);
+    line_release(bus->sda);
+    line_release(bus->scl);
+    busy_wait_us(I2C_BUS_RECOVERY_HALF_US);
+
+    // Um escravo interrompido no meio de um byte segura SDA até receber os
+    // pulsos que faltam
+    for (int i = 0; i < I2C_BUS_RECOVERY_PULSES && !gpio_get(bus->sda); i++) {
+        line_low(bus->scl);
+        busy_wait_us(I2C_BUS_RECOVERY_HALF_US);
+        line_release(bus->scl);
+        busy_wait_us(I2C_BUS_RECOVERY_HALF_US);
+    }
+
+    // STOP: SDA sobe com SCL alto
+    line_low(bus->sda);
+    busy_wait_us(I2C_BUS_RECOVERY_HALF_US);
+    line_release(bus->sda);
+    busy_wait_us(I2C_BUS_RECOVERY_HALF_US);
+
+    bus_setup(bus);
+}
+
+static void fall_back(i2c_bus_t* bus) {
+    uint32_t hz = bus->hz > 400000 ? 400000 : 100000;
+    if (hz < bus->min_hz) hz = bus->min_hz;
+    if (hz >= bus->hz) return;
+    bus->hz = hz;
+    bus->fallbacks++;
+    bus_setup(bus);
+}
+
+static void step_up(i2c_bus_t* bus) {
+    uint32_t hz = bus->hz < 400000 ? 400000 : bus->max_hz;
+    if (hz > bus->max_hz) hz = bus->max_hz;
+    bus->hz = hz;
+    bus->step_ups++;
+    bus_setup(bus);
+}
+
+bool i2c_bus_write(i2c_bus_t* bus, uint8_t addr, const uint8_t* src, size_t len, absolute_time_t deadline) {
+    uint32_t limit_us = i2c_bus_write_limit_us(bus, len);
+    absolute_time_t start = get_absolute_time();
+    absolute_time_t until = delayed_by_us(start, limit_us);
+    if (absolute_time_diff_us(deadline, until) > 0) until = deadline;
+
+    int ret = i2c_write_blocking_until(bus->port, addr, src, len, false, until);
+    bus->busy_us += absolute_time_diff_us(start, get_absolute_time());
+    bus->transfers++;
+
+    if (ret == (int)len) {
+        bus->bytes += len;
+        bus->fails_in_row = 0;
+        if (bus->hz < bus->max_hz && ++bus->clean_in_row >= I2C_BUS_STEP_UP_TRANSFERS) {
+            bus->clean_in_row = 0;
+            step_up(bus);
+        }
+        return true;
+    }
+
+    if (ret == PICO_ERROR_TIMEOUT) {
+        bus->timeouts++;
+    } else {
+        bus->naks++;
+    }
+    bus->clean_in_row = 0;
+    i2c_bus_recover(bus);
+    if (++bus->fails_in_row >= I2C_BUS_FALLBACK_ERRORS) {
+        bus->fails_in_row = 0;
+        fall_back(bus);
+    }
+    return false;
+}
+
+void i2c_bus_print_stats(const i2c_bus_t* bus) {
+    printf("I2C: %lu kHz, %lu transferencias, %lu bytes, %lu NAKs, %lu timeouts, "
+           "%lu recuperacoes, %lu recuos, %lu subidas, %llu us no barramento\n",
+           (unsigned long)(bus->actual_hz / 1000), (unsigned long)bus->transfers,
+           (unsigned long)bus->bytes, (unsigned long)bus->naks, (unsigned long)bus->timeouts,
+           (unsigned long)bus->recoveries, (unsigned long)bus->fallbacks,
+           (unsigned long)bus->step_ups,
+           (unsigned long long)bus->busy_us);
+}
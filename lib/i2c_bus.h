@@ -0,0 +1,77 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+
+// Barramento I2C mestre com tempo limitado, recuperação e estatísticas.
+//
+// Cada escrita tem prazo proporcional ao tamanho na velocidade atual (o
+// dobro do tempo nominal + I2C_BUS_SLACK_US), limitado ainda pelo prazo do
+// chamador. NAK ou estouro do prazo contam como erro e o barramento é
+// recuperado na hora: o periférico é desligado, até 9 pulsos de SCL são
+// gerados por GPIO até o escravo soltar SDA, segue uma condição de STOP e
+// o periférico é reiniciado. Após I2C_BUS_FALLBACK_ERRORS falhas seguidas a
+// velocidade desce um degrau (Fast-mode Plus 1 MHz -> Fast-mode 400 kHz ->
+// Standard 100 kHz), sem passar de min_hz; o display usa piso de 400 kHz,
+// porque a 100 kHz um quadro não cabe em DISPLAY_MAX_BLOCK_US. Após
+// I2C_BUS_STEP_UP_TRANSFERS escritas seguidas sem erro a velocidade sobe um
+// degrau de volta, até a pedida no i2c_bus_init: um ruído passageiro não
+// prende o barramento no piso até o reboot, e um enlace que não aguenta a
+// velocidade maior custa no máximo I2C_BUS_FALLBACK_ERRORS escritas perdidas
+// a cada subida.
+
+#define I2C_BUS_SLACK_US        100
+#define I2C_BUS_FALLBACK_ERRORS 3
+#define I2C_BUS_STEP_UP_TRANSFERS 1000 // ~100 quadros do display
+#define I2C_BUS_RECOVERY_PULSES 9
+#define I2C_BUS_RECOVERY_HALF_US 5 // SCL a 100 kHz durante a recuperação
+// Pior caso de i2c_bus_recover(): espera inicial, pulsos, STOP e a
+// reconfiguração do periférico
+#define I2C_BUS_RECOVERY_US (I2C_BUS_RECOVERY_HALF_US * (2 * I2C_BUS_RECOVERY_PULSES + 3) + 50)
+
+typedef struct {
+    i2c_inst_t* port;
+    uint sda;
+    uint scl;
+    uint32_t hz;            // Velocidade pedida no degrau atual
+    uint32_t max_hz;        // Velocidade pedida no i2c_bus_init, teto da subida
+    uint32_t min_hz;        // Piso do recuo automático
+    uint32_t actual_hz;     // Velocidade real devolvida por i2c_init
+    uint32_t byte_ns;       // Duração de um byte (9 bits) em actual_hz
+    uint8_t fails_in_row;
+    uint16_t clean_in_row;  // Escritas sem erro desde o último recuo
+
+    // Estatísticas
+    uint32_t transfers;
+    uint32_t bytes;
+    uint32_t naks;
+    uint32_t timeouts;
+    uint32_t recoveries;
+    uint32_t fallbacks;
+    uint32_t step_ups;
+    uint64_t busy_us;       // Tempo dentro das escritas
+} i2c_bus_t;
+
+void i2c_bus_init(i2c_bus_t* bus, i2c_inst_t* port, uint sda, uint scl, uint32_t hz, uint32_t min_hz);
+
+// Prazo próprio de uma escrita de len bytes na velocidade atual: o dobro do
+// tempo nominal de endereço + dados, mais a folga
+static inline uint32_t i2c_bus_write_limit_us(const i2c_bus_t* bus, size_t len) {
+    return (uint32_t)(len + 1) * bus->byte_ns / 500u + I2C_BUS_SLACK_US;
+}
+
+// Escreve len bytes em addr até deadline no máximo. Em caso de erro o
+// barramento já volta recuperado e a função devolve false.
+bool i2c_bus_write(i2c_bus_t* bus, uint8_t addr, const uint8_t* src, size_t len, absolute_time_t deadline);
+
+// Libera um escravo preso segurando SDA e reinicia o periférico
+void i2c_bus_recover(i2c_bus_t* bus);
+
+static inline uint32_t i2c_bus_errors(const i2c_bus_t* bus) {
+    return bus->naks + bus->timeouts;
+}
+
+void i2c_bus_print_stats(const i2c_bus_t* bus);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef PINS_H
+#define PINS_H
+
+#include "ssd1306.h" // Pinos do barramento do display
+
+// Definições de pinos
+#define BUZZER_PIN     21
+#define JOYSTICK_X     27
+#define JOYSTICK_Y     26
+#define JOYSTICK_BTN   22
+#define BTN_A          5
+#define BTN_B          6
+#define LED_R          13
+#define LED_G          11
+#define LED_B          12
+#define WS2812_PIN     7
+#define SERVO_PIN      16 // Válvula da mostura (GP15 é o SCL do display)
+#define HLT_VALVE_PIN  17 // Válvula do tanque de água quente
+#define BOIL_VALVE_PIN 18 // Válvula da panela de fervura
+#define SPARE_VALVE_PIN 19 // Quarta panela opcional (VESSEL_COUNT = 4)
+#define ONEWIRE_PIN    8  // Barramento 1-Wire das sondas DS18B20 (pull-up de 4k7)
+
+#if DISPLAY_TRANSPORT == DISPLAY_SPI
+#define DISPLAY_PINS(op) (PIN_MASK(DISPLAY_SPI_SCK) op PIN_MASK(DISPLAY_SPI_MOSI) op \
+                          PIN_MASK(DISPLAY_SPI_CS) op PIN_MASK(DISPLAY_SPI_DC) op     \
+                          PIN_MASK(DISPLAY_SPI_RST))
+#else
+#define DISPLAY_PINS(op) (PIN_MASK(I2C_SDA) op PIN_MASK(I2C_SCL))
+#endif
+
+// Verificação de conflitos em tempo de compilação: a soma das máscaras só é
+// igual ao OU quando nenhum pino aparece duas vezes.
+#define PIN_MASK(p) (1ull << (p))
+#define USED_PINS(op) (PIN_MASK(BUZZER_PIN) op PIN_MASK(JOYSTICK_X) op PIN_MASK(JOYSTICK_Y) op \
+                       PIN_MASK(JOYSTICK_BTN) op PIN_MASK(BTN_A) op PIN_MASK(BTN_B) op        \
+                       PIN_MASK(LED_R) op PIN_MASK(LED_G) op PIN_MASK(LED_B) op               \
+                       PIN_MASK(WS2812_PIN) op PIN_MASK(SERVO_PIN) op PIN_MASK(HLT_VALVE_PIN) op \
+                       PIN_MASK(BOIL_VALVE_PIN) op PIN_MASK(SPARE_VALVE_PIN) op               \
+                       PIN_MASK(ONEWIRE_PIN) op DISPLAY_PINS(op))
+_Static_assert(USED_PINS(+) == USED_PINS(|), "Conflito de pinos: dois perifericos no mesmo GPIO");
+
+// Saídas PWM com frequências diferentes não podem dividir o mesmo slice
+// (as válvulas rodam todas a 50 Hz e podem compartilhar entre si)
+#define PWM_SLICE(p) (((p) >> 1) & 7)
+#define NOT_ON_SLICE(p, s) (PWM_SLICE(p) != PWM_SLICE(s))
+#define VALVE_NOT_ON_SLICE(s) (NOT_ON_SLICE(SERVO_PIN, s) && NOT_ON_SLICE(HLT_VALVE_PIN, s) && \
+                               NOT_ON_SLICE(BOIL_VALVE_PIN, s) && NOT_ON_SLICE(SPARE_VALVE_PIN, s))
+_Static_assert(VALVE_NOT_ON_SLICE(LED_R) && VALVE_NOT_ON_SLICE(BUZZER_PIN) &&
+               NOT_ON_SLICE(LED_R, BUZZER_PIN),
+               "Conflito de PWM: valvulas, LED vermelho e buzzer precisam de slices distintos");
+
+// O ADC só existe nos GPIOs 26 a 29
+_Static_assert(JOYSTICK_X >= 26 && JOYSTICK_X <= 29 && JOYSTICK_Y >= 26 && JOYSTICK_Y <= 29,
+               "Joystick precisa estar em um pino de ADC (GP26-GP29)");
+
+#endif
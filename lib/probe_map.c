@@ -0,0 +1,116 @@
+#include <stdio.h>
+#include <string.h>
+#include "probe_map.h"
+#include "brewlog.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+// Um setor logo abaixo da região do registro das corridas
+#define PROBE_MAP_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - BREWLOG_FLASH_BYTES - FLASH_SECTOR_SIZE)
+#define PROBE_MAP_WRITE_US     (BREWLOG_ERASE_US + 1000) // Apagamento + uma página
+
+typedef struct {
+    uint32_t magic;
+    uint8_t rom[VESSEL_MAX][8];
+} probe_map_record_t;
+
+_Static_assert(PROBE_MAP_FLASH_OFFSET % FLASH_SECTOR_SIZE == 0, "setor do mapa desalinhado");
+_Static_assert(sizeof(probe_map_record_t) <= FLASH_PAGE_SIZE, "mapa maior que uma pagina");
+
+extern char __flash_binary_end;
+
+static const probe_map_record_t* stored(void) {
+    const probe_map_record_t* r = (const probe_map_record_t*)(XIP_BASE + PROBE_MAP_FLASH_OFFSET);
+    return r->magic == PROBE_MAP_MAGIC ? r : NULL;
+}
+
+static bool rom_empty(const uint8_t* rom) {
+    return rom[0] == 0; // Código de família nunca é 0
+}
+
+void probe_map_init(probe_map_t* map) {
+    memset(map, 0, sizeof(*map));
+    map->enabled = (uintptr_t)&__flash_binary_end - XIP_BASE <= PROBE_MAP_FLASH_OFFSET;
+    if (!map->enabled) {
+        printf("sondas: binario invade o setor do mapa, associacao nao sera gravada\n");
+        return;
+    }
+    const probe_map_record_t* r = stored();
+    if (r) memcpy(map->rom, r->rom, sizeof(map->rom));
+}
+
+static void print_rom(const uint8_t* rom) {
+    for (int b = 0; b < 8; b++) printf("%02x", rom[b]);
+}
+
+bool probe_map_update(probe_map_t* map, const ds18b20_bus_t* bus, int8_t* sensor, uint8_t count) {
+    uint16_t searches = bus->searches;
+    if (searches == map->searches) return false;
+    map->searches = searches;
+
+    // rom[] só muda no fim da próxima busca, que começa DS18B20_RESCAN_CYCLES
+    // conversões (ou 1 s depois de uma falha) adiante: a leitura abaixo não
+    // corre com o timer do barramento
+    uint8_t found = bus->probe_count;
+    bool owned[DS18B20_MAX_PROBES] = {false};
+    int8_t channel[VESSEL_MAX];
+
+    // Panelas com sonda conhecida: o canal que tem a sua ROM
+    for (uint8_t v = 0; v < count; v++) {
+        channel[v] = DS18B20_NO_PROBE;
+        if (rom_empty(map->rom[v])) continue;
+        for (uint8_t p = 0; p < found; p++) {
+            if (!owned[p] && memcmp(map->rom[v], bus->rom[p], 8) == 0) {
+                channel[v] = p;
+                owned[p] = true;
+                break;
+            }
+        }
+    }
+
+    // Sondas desconhecidas: para as panelas sem sonda no barramento
+    uint8_t p = 0;
+    for (uint8_t v = 0; v < count; v++) {
+        if (channel[v] != DS18B20_NO_PROBE) continue;
+        while (p < found && owned[p]) p++;
+        if (p == found) break;
+        channel[v] = p;
+        owned[p] = true;
+        memcpy(map->rom[v], bus->rom[p], 8);
+        map->dirty = true;
+        printf("sondas: panela %u associada a ROM ", v);
+        print_rom(map->rom[v]);
+        printf("\n");
+    }
+
+    bool changed = false;
+    for (uint8_t v = 0; v < count; v++) {
+        if (sensor[v] == channel[v]) continue;
+        sensor[v] = channel[v];
+        changed = true;
+        if (channel[v] == DS18B20_NO_PROBE) printf("sondas: panela %u sem sonda no barramento\n", v);
+    }
+    return changed;
+}
+
+// Mesmo cuidado do registro: as rotinas da flash rodam da SRAM, com as
+// interrupções desligadas, e o apagamento (até BREWLOG_ERASE_MAX_US) só
+// acontece com as válvulas fechadas
+void probe_map_service(probe_map_t* map, const vessels_t* v, absolute_time_t deadline) {
+    if (!map->enabled || !map->dirty || vessels_any_running(v)) return;
+    if (absolute_time_diff_us(get_absolute_time(), deadline) < PROBE_MAP_WRITE_US) return;
+
+    static uint8_t page[FLASH_PAGE_SIZE];
+    memset(page, 0xFF, sizeof(page));
+    probe_map_record_t* r = (probe_map_record_t*)page;
+    r->magic = PROBE_MAP_MAGIC;
+    memcpy(r->rom, map->rom, sizeof(r->rom));
+
+    uint32_t irq = save_and_disable_interrupts();
+    flash_range_erase(PROBE_MAP_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+    restore_interrupts(irq);
+    irq = save_and_disable_interrupts();
+    flash_range_program(PROBE_MAP_FLASH_OFFSET, page, FLASH_PAGE_SIZE);
+    restore_interrupts(irq);
+    map->dirty = false;
+}
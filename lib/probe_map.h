@@ -0,0 +1,42 @@
+#ifndef PROBE_MAP_H
+#define PROBE_MAP_H
+
+#include "pico/stdlib.h"
+#include "ds18b20.h"
+#include "vessel.h"
+
+// Associação persistente entre panelas e sondas DS18B20 pela ROM.
+//
+// A ordem da busca de ROM muda quando uma sonda entra ou sai do barramento,
+// então o canal de cada panela não pode ser a posição na busca. O mapa
+// guarda a ROM da sonda de cada panela num setor da flash logo abaixo do
+// registro das corridas e, a cada busca que muda as sondas (inclusive as
+// buscas periódicas com o barramento saudável), aponta cada panela para o
+// canal que tem a sua ROM. Panela cuja sonda não respondeu fica sem
+// leitura (DS18B20_NO_PROBE) e a válvula fecha. Sondas desconhecidas vão
+// para as panelas sem sonda, na ordem da busca: no primeiro boot todas, e
+// depois só quando uma sonda é trocada. O mapa alterado é gravado na folga
+// do tick e, como os setores do registro, só com as panelas paradas: o
+// apagamento não cabe no limite de reação do intertravamento (safety.h).
+
+#define PROBE_MAP_MAGIC 0x424F5250u // "PROB"
+
+typedef struct {
+    bool enabled;                  // false se o setor colidir com o binário
+    bool dirty;                    // Mapa mudou e ainda não foi gravado
+    uint16_t searches;             // Última busca associada
+    uint8_t rom[VESSEL_MAX][8];    // ROM da sonda de cada panela (0 = nenhuma)
+} probe_map_t;
+
+// Lê o mapa gravado
+void probe_map_init(probe_map_t* map);
+
+// Chamado a cada tick: depois de cada busca concluída, reassocia os canais
+// das count primeiras panelas pela ROM. Devolve true se algum canal mudou.
+bool probe_map_update(probe_map_t* map, const ds18b20_bus_t* bus, int8_t* sensor, uint8_t count);
+
+// Grava o mapa alterado, só com todas as panelas paradas e se couber até
+// deadline (o próximo tick)
+void probe_map_service(probe_map_t* map, const vessels_t* v, absolute_time_t deadline);
+
+#endif
@@ -0,0 +1,50 @@
+#include "pwm_channel.h"
+#include "hardware/clocks.h"
+
+void pwm_channel_init(pwm_channel_t* ch, uint gpio, uint32_t freq_hz) {
+    uint64_t clk16 = (uint64_t)clock_get_hz(clk_sys) * 16; // Clock em 1/16 de ciclo
+
+    // Menor divisor (em 1/16) que faz o período caber em 65536 contagens
+    uint64_t div16 = (clk16 + (uint64_t)freq_hz * 65536 - 1) / ((uint64_t)freq_hz * 65536);
+    if (div16 < 16) div16 = 16;                // Divisor mínimo 1.0
+    if (div16 > 255 * 16 + 15) div16 = 255 * 16 + 15;
+
+    uint64_t wrap = clk16 / (div16 * freq_hz) - 1;
+    if (wrap > 0xFFFF) wrap = 0xFFFF;
+
+    ch->gpio = gpio;
+    ch->slice = pwm_gpio_to_slice_num(gpio);
+    ch->chan = pwm_gpio_to_channel(gpio);
+    ch->wrap = (uint16_t)wrap;
+    ch->div_int = (uint8_t)(div16 >> 4);
+    ch->div_frac = (uint8_t)(div16 & 0x0F);
+
+    gpio_set_function(gpio, GPIO_FUNC_PWM);
+    pwm_set_clkdiv_int_frac(ch->slice, ch->div_int, ch->div_frac);
+    pwm_set_wrap(ch->slice, ch->wrap);
+    pwm_set_chan_level(ch->slice, ch->chan, 0);
+    pwm_set_enabled(ch->slice, true);
+}
+
+uint16_t pwm_channel_level_for_us(const pwm_channel_t* ch, uint32_t freq_hz, uint32_t pulse_us) {
+    uint32_t period_us = 1000000u / freq_hz;
+    return (uint16_t)(((uint64_t)ch->wrap + 1) * pulse_us / period_us);
+}
+
+static uint16_t servo_levels[SERVO_MAX_ANGLE + 1];
+static uint16_t servo_levels_wrap; // wrap para o qual a tabela foi calculada
+
+void servo_init(servo_t* servo, uint gpio) {
+    pwm_channel_init(&servo->pwm, gpio, SERVO_FREQ_HZ);
+
+    // Pulso de 1 ms (0°) a 2 ms (180°), calculado uma vez para todos os ângulos
+    if (servo_levels_wrap != servo->pwm.wrap) {
+        for (uint a = 0; a <= SERVO_MAX_ANGLE; a++) {
+            uint32_t pulse_us = SERVO_MIN_PULSE_US +
+                                a * (SERVO_MAX_PULSE_US - SERVO_MIN_PULSE_US) / SERVO_MAX_ANGLE;
+            servo_levels[a] = pwm_channel_level_for_us(&servo->pwm, SERVO_FREQ_HZ, pulse_us);
+        }
+        servo_levels_wrap = servo->pwm.wrap;
+    }
+    servo->levels = servo_levels;
+}
@@ -0,0 +1,50 @@
+#ifndef PWM_CHANNEL_H
+#define PWM_CHANNEL_H
+
+#include "pico/stdlib.h"
+#include "hardware/pwm.h"
+
+// Configuração de um canal PWM calculada uma única vez na inicialização.
+// O divisor (8.4 bits) é o menor que mantém o contador em 16 bits, o que
+// dá o maior wrap possível, ou seja, a maior resolução para a frequência.
+typedef struct {
+    uint gpio;
+    uint slice;
+    uint chan;
+    uint16_t wrap;
+    uint8_t div_int;
+    uint8_t div_frac;
+} pwm_channel_t;
+
+#define SERVO_MAX_ANGLE   180
+#define SERVO_FREQ_HZ     50
+#define SERVO_MIN_PULSE_US 1000
+#define SERVO_MAX_PULSE_US 2000
+
+// Servo com tabela ângulo -> nível PWM pré-calculada. Todos os servos rodam
+// a SERVO_FREQ_HZ com o mesmo wrap, então a tabela é única e compartilhada.
+typedef struct {
+    pwm_channel_t pwm;
+    const uint16_t* levels;
+} servo_t;
+
+void pwm_channel_init(pwm_channel_t* ch, uint gpio, uint32_t freq_hz);
+uint16_t pwm_channel_level_for_us(const pwm_channel_t* ch, uint32_t freq_hz, uint32_t pulse_us);
+
+static inline void pwm_channel_set_level(const pwm_channel_t* ch, uint16_t level) {
+    pwm_set_chan_level(ch->slice, ch->chan, level);
+}
+
+// Duty em escala de 12 bits (0..4095), independente do wrap escolhido
+static inline void pwm_channel_set_duty12(const pwm_channel_t* ch, uint16_t duty) {
+    pwm_set_chan_level(ch->slice, ch->chan, (uint16_t)(((uint32_t)duty * ((uint32_t)ch->wrap + 1)) >> 12));
+}
+
+void servo_init(servo_t* servo, uint gpio);
+
+static inline void servo_set_angle(const servo_t* servo, uint8_t angle) {
+    if (angle > SERVO_MAX_ANGLE) angle = SERVO_MAX_ANGLE;
+    pwm_channel_set_level(&servo->pwm, servo->levels[angle]);
+}
+
+#endif
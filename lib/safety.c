@@ -0,0 +1,193 @@
+#include <stdio.h>
+#include "safety.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/watchdog.h"
+#include "hardware/sync.h"
+
+#define SAFETY_SCRATCH       0           // Registrador de rascunho com o motivo
+#define SAFETY_SCRATCH_MAGIC 0x5AFE0000u
+// Recarga do watchdog escrita direto no registrador: watchdog_update() fica
+// na flash. RP2040-E1: o contador decrementa duas vezes por microssegundo.
+#define SAFETY_WATCHDOG_LOAD (SAFETY_WATCHDOG_MS * 1000u * 2u)
+
+// Uma única instância, usada pela interrupção
+static safety_t* active;
+
+static const char* const REASON_NAMES[] = {
+    "OK", "Sobretemp.", "Sonda muda", "Valv. travada", "Laco travado", "Reinicio",
+};
+
+const char* safety_reason_name(uint8_t reason) {
+    return reason < count_of(REASON_NAMES) ? REASON_NAMES[reason] : "?";
+}
+
+// Tudo o que a interrupção executa até forçar as saídas fica na SRAM:
+// nenhuma falta de cache do XIP entra no tempo de reação.
+static void __not_in_flash_func(trip)(safety_t* s, uint8_t reason, uint8_t vessel) {
+    if (s->reason != SAFETY_OK) return;
+    s->reason = reason;
+    s->trip_vessel = vessel;
+    watchdog_hw->scratch[SAFETY_SCRATCH] = SAFETY_SCRATCH_MAGIC | ((uint32_t)vessel << 8) | reason;
+}
+
+static void __not_in_flash_func(check_vessels)(safety_t* s, uint32_t now_us) {
+    for (uint8_t i = 0; i < s->count; i++) {
+        int16_t t = s->temp16[i];
+        bool have_t = true;
+#ifdef U7T_DS18B20
+        int8_t probe = s->sensor[i];
+        if (probe >= 0) {
+            // Sonda ausente (DS18B20_NO_PROBE): nunca tem leitura
+            uint32_t sample = probe < DS18B20_MAX_PROBES ? s->probes->sample[probe] : 0;
+            uint16_t seq = (uint16_t)(sample >> 16);
+            if (seq != s->seq[i]) {
+                s->seq[i] = seq;
+                if (seq) s->seen_us[i] = now_us;
+            }
+            have_t = seq != 0;
+            t = (int16_t)(sample & 0xFFFF);
+
+            if (s->angle[i] && now_us - s->seen_us[i] > SAFETY_SENSOR_MAX_AGE_MS * 1000u) {
+                trip(s, SAFETY_SENSOR_STALE, i);
+            }
+            // Válvula fechada e a panela continua esquentando
+            if (s->angle[i]) {
+                s->was_open[i] = true;
+            } else if (have_t) {
+                if (s->was_open[i]) {
+                    s->was_open[i] = false;
+                    s->stuck_armed[i] = true;
+                    s->closed_us[i] = now_us;
+                    s->closed_ref[i] = t;
+                }
+                if (s->stuck_armed[i]) {
+                    if (t < s->closed_ref[i]) s->closed_ref[i] = t;
+                    if (t - s->closed_ref[i] > SAFETY_STUCK_RISE_C * 16) trip(s, SAFETY_STUCK_VALVE, i);
+                    if (now_us - s->closed_us[i] > SAFETY_STUCK_WINDOW_MS * 1000u) s->stuck_armed[i] = false;
+                }
+            }
+        }
+#endif
+        if (have_t && t > SAFETY_TEMP_MAX_C * 16) trip(s, SAFETY_OVERTEMP, i);
+    }
+}
+
+static void __not_in_flash_func(safety_isr)(void) {
+    safety_t* s = active;
+    uint32_t entry = timer_hw->timerawl;
+    timer_hw->intr = 1u << s->alarm;
+
+    // Próximo alvo sem deriva; se as interrupções ficaram mascaradas por
+    // mais de um período, recomeça a partir de agora
+    s->target_us += SAFETY_PERIOD_US;
+    if ((int32_t)(s->target_us - entry) < (int32_t)(SAFETY_PERIOD_US / 2)) s->target_us = entry + SAFETY_PERIOD_US;
+    timer_hw->alarm[s->alarm] = s->target_us;
+
+    // O limite vale com alguma válvula aberta; com todas fechadas a flash
+    // pode ser apagada e o intervalo não conta
+    bool open = false;
+    for (uint8_t i = 0; i < s->count; i++) open |= s->angle[i] != 0;
+    if (s->checks && (open || s->any_open)) {
+        uint32_t gap = entry - s->last_entry_us;
+        if (gap > s->max_gap_us) s->max_gap_us = gap;
+        if (gap > SAFETY_REACTION_BOUND_US) s->overruns++;
+    }
+    s->any_open = open;
+    s->last_entry_us = entry;
+    s->checks++;
+
+    bool loop_alive = entry - s->kick_us < SAFETY_LOOP_TIMEOUT_MS * 1000u;
+    if (!loop_alive) trip(s, SAFETY_LOOP_STALL, 0);
+    check_vessels(s, entry);
+
+    // Desarmado: reimpõe as saídas a cada período, mesmo que o laço as mude
+    if (s->reason != SAFETY_OK) {
+        for (uint8_t i = 0; i < s->count; i++) servo_set_angle(&s->valves[i], 0);
+        pwm_channel_set_level(s->buzzer, s->buzzer_level);
+    }
+
+    // Laço travado: as válvulas já estão fechadas e o watchdog reinicia o chip
+    if (loop_alive) watchdog_hw->load = SAFETY_WATCHDOG_LOAD;
+
+    uint32_t took = timer_hw->timerawl - entry;
+    if (took > s->max_isr_us) s->max_isr_us = took;
+}
+
+#ifdef U7T_DS18B20
+void safety_init(safety_t* s, const servo_t* valves, uint8_t count, const pwm_channel_t* buzzer,
+                 uint16_t buzzer_level, const int8_t* sensor, const ds18b20_bus_t* probes) {
+    s->probes = probes;
+#else
+void safety_init(safety_t* s, const servo_t* valves, uint8_t count, const pwm_channel_t* buzzer,
+                 uint16_t buzzer_level, const int8_t* sensor) {
+#endif
+    s->count = count;
+    s->valves = valves;
+    s->buzzer = buzzer;
+    s->buzzer_level = buzzer_level;
+    s->sensor = sensor;
+    s->reason = SAFETY_OK;
+    s->checks = 0;
+    s->max_gap_us = 0;
+    s->max_isr_us = 0;
+    s->overruns = 0;
+    s->any_open = false;
+    s->kick_us = time_us_32();
+    for (uint8_t i = 0; i < VESSEL_MAX; i++) {
+        s->temp16[i] = 0;
+        s->angle[i] = 0;
+        s->seq[i] = 0;
+        s->seen_us[i] = s->kick_us;
+        s->was_open[i] = false;
+        s->stuck_armed[i] = false;
+    }
+
+    // Reinício pelo watchdog: mantém o alarme até o operador rearmar
+    uint32_t saved = watchdog_hw->scratch[SAFETY_SCRATCH];
+    if (watchdog_enable_caused_reboot()) {
+        s->reason = SAFETY_REBOOT;
+        if ((saved & 0xFFFF0000u) == SAFETY_SCRATCH_MAGIC) {
+            printf("Seguranca: reinicio pelo watchdog apos '%s' (panela %lu)\n",
+                   safety_reason_name(saved & 0xFF), (saved >> 8) & 0xFF);
+        } else {
+            printf("Seguranca: reinicio pelo watchdog\n");
+        }
+    } else {
+        watchdog_hw->scratch[SAFETY_SCRATCH] = 0;
+    }
+
+    active = s;
+    s->alarm = hardware_alarm_claim_unused(true);
+    uint irq = TIMER_IRQ_0 + s->alarm;
+    irq_set_exclusive_handler(irq, safety_isr);
+    irq_set_priority(irq, PICO_HIGHEST_IRQ_PRIORITY);
+    hw_set_bits(&timer_hw->inte, 1u << s->alarm);
+    irq_set_enabled(irq, true);
+    s->target_us = timer_hw->timerawl + SAFETY_PERIOD_US;
+    timer_hw->alarm[s->alarm] = s->target_us;
+
+    watchdog_enable(SAFETY_WATCHDOG_MS, true);
+}
+
+void safety_publish(safety_t* s, const vessels_t* v) {
+    for (uint8_t i = 0; i < s->count; i++) {
+        s->temp16[i] = (int16_t)(v->temperature[i] * 16.0f);
+        s->angle[i] = v->servo_angle[i];
+    }
+    s->kick_us = time_us_32();
+}
+
+void safety_set_valve(safety_t* s, uint8_t i, uint8_t angle) {
+    uint32_t irq = save_and_disable_interrupts();
+    servo_set_angle(&s->valves[i], s->reason == SAFETY_OK ? angle : 0);
+    restore_interrupts(irq);
+}
+
+void safety_reset(safety_t* s) {
+    for (uint8_t i = 0; i < VESSEL_MAX; i++) s->stuck_armed[i] = false;
+    watchdog_hw->scratch[SAFETY_SCRATCH] = 0;
+    s->reason = SAFETY_OK;
+    pwm_channel_set_level(s->buzzer, 0);
+}
@@ -0,0 +1,136 @@
+#ifndef SAFETY_H
+#define SAFETY_H
+
+#include "pico/stdlib.h"
+#include "pwm_channel.h"
+#include "vessel.h"
+#if defined(U7T_BREWLOG) || defined(U7T_DS18B20)
+#include "brewlog.h"
+#endif
+#ifdef U7T_DS18B20
+#include "ds18b20.h"
+#endif
+
+// Intertravamento de segurança independente do laço principal.
+//
+// Um alarme de hardware do timer, na prioridade de IRQ mais alta e rodando
+// da SRAM, verifica a cada SAFETY_PERIOD_US:
+//   - temperatura absoluta de cada panela acima de SAFETY_TEMP_MAX_C
+//   - sonda sem leitura nova há SAFETY_SENSOR_MAX_AGE_MS com a válvula aberta
+//   - válvula travada: nos SAFETY_STUCK_WINDOW_MS após o fechamento a
+//     temperatura medida sobe mais de SAFETY_STUCK_RISE_C
+//   - laço de controle sem chamar safety_publish() há SAFETY_LOOP_TIMEOUT_MS
+// No desarme todas as válvulas são fechadas e o buzzer soa na mesma
+// interrupção, e a cada período seguinte enquanto o alarme estiver armado,
+// de modo que o laço não consegue reabri-las. O watchdog só é alimentado
+// por essa interrupção e só enquanto o laço estiver vivo: se a própria
+// interrupção parar, ou o laço travar, o chip reinicia e o motivo é
+// preservado nos registradores de rascunho do watchdog.
+//
+// Limite de reação (SAFETY_REACTION_BOUND_US) = SAFETY_PERIOD_US + o maior
+// trecho com as interrupções mascaradas enquanto alguma panela está em
+// execução: a programação de uma página da flash. Os apagamentos (até
+// BREWLOG_ERASE_MAX_US) só acontecem com todas as panelas paradas, no
+// brewlog e no mapa das sondas. A interrupção também mede o pior caso real
+// com alguma válvula aberta (maior intervalo entre verificações + maior
+// duração) e conta os intervalos acima do limite. As válvulas são escritas pelo laço através
+// de safety_set_valve(), que confere o alarme atomicamente, então um
+// desarme nunca é desfeito pela escrita seguinte do laço.
+
+#define SAFETY_PERIOD_US         2000
+#define SAFETY_TEMP_MAX_C        105
+#define SAFETY_SENSOR_MAX_AGE_MS 3000  // Acima dos 2 s em que o laço já fecha a válvula
+#define SAFETY_STUCK_RISE_C      3
+#define SAFETY_STUCK_WINDOW_MS   300000
+#define SAFETY_LOOP_TIMEOUT_MS   1000  // Display + apagamento da flash (com as panelas paradas) cabem
+#define SAFETY_WATCHDOG_MS       2000
+
+// Maior trecho com as interrupções mascaradas com alguma panela em
+// execução: a programação de uma página pelo brewlog
+#if defined(U7T_BREWLOG) || defined(U7T_DS18B20)
+#define SAFETY_IRQ_OFF_MAX_US    BREWLOG_IRQ_OFF_MAX_US
+_Static_assert(BREWLOG_ERASE_MAX_US < SAFETY_LOOP_TIMEOUT_MS * 1000,
+               "Apagamento da flash maior que o prazo do laco");
+#else
+#define SAFETY_IRQ_OFF_MAX_US    0
+#endif
+// Limite de reação: um período + o maior trecho mascarado
+#define SAFETY_REACTION_BOUND_US (SAFETY_PERIOD_US + SAFETY_IRQ_OFF_MAX_US)
+_Static_assert(SAFETY_REACTION_BOUND_US <= 5000, "Limite de reacao do intertravamento acima de 5 ms");
+
+typedef enum {
+    SAFETY_OK = 0,
+    SAFETY_OVERTEMP,
+    SAFETY_SENSOR_STALE,
+    SAFETY_STUCK_VALVE,
+    SAFETY_LOOP_STALL,
+    SAFETY_REBOOT,       // O watchdog reiniciou o chip
+} safety_reason_t;
+
+typedef struct {
+    // Configuração
+    uint8_t count;
+    const servo_t* valves;
+    const pwm_channel_t* buzzer;
+    uint16_t buzzer_level;
+    const int8_t* sensor;               // Canal da sonda de cada panela ou -1
+#ifdef U7T_DS18B20
+    const ds18b20_bus_t* probes;
+#endif
+    uint alarm;
+
+    // Publicado pelo laço a cada tick
+    volatile int16_t temp16[VESSEL_MAX]; // Temperatura em 1/16 °C (panelas sem sonda)
+    volatile uint8_t angle[VESSEL_MAX];  // Ângulo comandado da válvula
+    volatile uint32_t kick_us;
+
+    // Estado da interrupção
+    volatile uint8_t reason;            // safety_reason_t; != SAFETY_OK = desarmado
+    volatile uint8_t trip_vessel;
+    uint32_t target_us;
+    uint32_t last_entry_us;
+    uint16_t seq[VESSEL_MAX];           // Última leitura vista de cada sonda
+    uint32_t seen_us[VESSEL_MAX];       // Quando ela chegou
+    bool was_open[VESSEL_MAX];
+    bool stuck_armed[VESSEL_MAX];       // Observando a panela após fechar a válvula
+    uint32_t closed_us[VESSEL_MAX];
+    int16_t closed_ref[VESSEL_MAX];     // Menor temperatura desde o fechamento
+    bool any_open;                      // Alguma válvula aberta na última verificação
+
+    // Medições
+    volatile uint32_t checks;
+    volatile uint32_t max_gap_us;       // Maior intervalo entre verificações com válvula aberta
+    volatile uint32_t max_isr_us;       // Maior duração da interrupção
+    volatile uint32_t overruns;         // Intervalos acima de SAFETY_REACTION_BOUND_US
+} safety_t;
+
+#ifdef U7T_DS18B20
+void safety_init(safety_t* s, const servo_t* valves, uint8_t count, const pwm_channel_t* buzzer,
+                 uint16_t buzzer_level, const int8_t* sensor, const ds18b20_bus_t* probes);
+#else
+void safety_init(safety_t* s, const servo_t* valves, uint8_t count, const pwm_channel_t* buzzer,
+                 uint16_t buzzer_level, const int8_t* sensor);
+#endif
+
+// Chamado a cada tick: prova de vida do laço e entradas das panelas sem sonda
+void safety_publish(safety_t* s, const vessels_t* v);
+
+// Escreve a válvula i, ou 0 se o intertravamento estiver desarmado (sem
+// janela entre a verificação e a escrita)
+void safety_set_valve(safety_t* s, uint8_t i, uint8_t angle);
+
+// Rearma se a condição já não existir (a próxima verificação desarma de novo
+// se existir)
+void safety_reset(safety_t* s);
+
+static inline bool safety_tripped(const safety_t* s) {
+    return s->reason != SAFETY_OK;
+}
+
+static inline uint32_t safety_worst_case_us(const safety_t* s) {
+    return s->max_gap_us + s->max_isr_us;
+}
+
+const char* safety_reason_name(uint8_t reason);
+
+#endif
@@ -1,23 +1,118 @@
-#ifndef SSD1306_H
-#define SSD1306_H
-
-#include "pico/stdlib.h"
-
-#define DISPLAY_WIDTH  128
-#define DISPLAY_HEIGHT 64
-#define I2C_PORT       i2c1
-#define I2C_SDA        14
-#define I2C_SCL        15
-
-void ssd1306_init();
-void ssd1306_clear();
-void ssd1306_draw_pixel(int x, int y, bool color);
-void ssd1306_set_page_address(uint8_t start, uint8_t end);
-void ssd1306_set_column_address(uint8_t start, uint8_t end);
-void ssd1306_update();
-void ssd1306_draw_char(int x, int y, char c);
-void ssd1306_draw_string(int x, int y, const char *str);
-void ssd1306_draw_hline(int x0, int x1, int y, bool color);
-void ssd1306_draw_vline(int x, int y0, int y1, bool color);
-
-#endif
\ No newline at end of file
+#ifndef SSD1306_H
+#define SSD1306_H
+
+#include "pico/stdlib.h"
+
+// Backend do display escolhido em tempo de compilação (opções U7T_DISPLAY*
+// do CMakeLists.txt). Geometria, sequência de inicialização e estratégia de
+// envio são resolvidas pelo pré-processador, sem testar o controlador ou o
+// transporte em tempo de execução. As funções de desenho continuam fora de
+// linha e recortam cada pixel ou coluna de glifo nas bordas a cada chamada;
+// no perfil U7T_RAM_HOT_PATHS draw_pixel, draw_char, draw_string e a fonte
+// rodam da SRAM (lib/hot_path.h).
+//   DISPLAY_CONTROLLER  DISPLAY_SSD1306 ou DISPLAY_SH1106
+//   DISPLAY_HEIGHT      64 ou 32 (largura sempre 128)
+//   DISPLAY_TRANSPORT   DISPLAY_I2C ou DISPLAY_SPI
+#define DISPLAY_SSD1306 1
+#define DISPLAY_SH1106  2
+#define DISPLAY_I2C     1
+#define DISPLAY_SPI     2
+
+#ifndef DISPLAY_CONTROLLER
+#define DISPLAY_CONTROLLER DISPLAY_SSD1306
+#endif
+#ifndef DISPLAY_HEIGHT
+#define DISPLAY_HEIGHT 64
+#endif
+#ifndef DISPLAY_TRANSPORT
+#define DISPLAY_TRANSPORT DISPLAY_I2C
+#endif
+
+#define DISPLAY_WIDTH  128
+#define DISPLAY_PAGES  (DISPLAY_HEIGHT / 8)
+
+#if DISPLAY_HEIGHT != 64 && DISPLAY_HEIGHT != 32
+#error "DISPLAY_HEIGHT precisa ser 64 ou 32"
+#endif
+
+#if DISPLAY_CONTROLLER == DISPLAY_SH1106
+// RAM de 132 colunas com o painel de 128 centralizado, e sem os modos de
+// endereçamento horizontal/vertical: cada página é posicionada à parte
+#define DISPLAY_COL_OFFSET      2
+#define DISPLAY_PAGE_ADDRESSING 1
+#elif DISPLAY_CONTROLLER == DISPLAY_SSD1306
+#define DISPLAY_COL_OFFSET      0
+#define DISPLAY_PAGE_ADDRESSING 0
+#else
+#error "DISPLAY_CONTROLLER desconhecido"
+#endif
+
+// Maior tempo que ssd1306_update() pode bloquear, incluindo a
+// reinicialização do painel após uma recuperação do barramento
+#define DISPLAY_MAX_BLOCK_US 30000
+
+#if DISPLAY_TRANSPORT == DISPLAY_SPI
+// Pinos livres na placa; ajuste conforme o chicote do módulo SPI
+#define DISPLAY_SPI_PORT  spi0
+#define DISPLAY_SPI_SCK   2
+#define DISPLAY_SPI_MOSI  3
+#define DISPLAY_SPI_CS    20
+#define DISPLAY_SPI_DC    4
+#define DISPLAY_SPI_RST   9
+#define DISPLAY_SPI_HZ    (10 * 1000 * 1000) // Máximo dos dois controladores
+#elif DISPLAY_TRANSPORT == DISPLAY_I2C
+#define I2C_PORT          i2c1
+#define I2C_SDA           14
+#define I2C_SCL           15
+#define DISPLAY_I2C_ADDR  0x3C  // Endereço típico do SSD1306/SH1106, ajuste se necessário
+#ifndef DISPLAY_I2C_HZ
+#define DISPLAY_I2C_HZ    (1000 * 1000) // Fast-mode Plus, com recuo automático
+#endif
+#ifndef DISPLAY_I2C_MIN_HZ
+#define DISPLAY_I2C_MIN_HZ (400 * 1000)
+#endif
+#include "i2c_bus.h"
+// Pior caso de bytes por atualização: inicialização, posicionamento e
+// páginas, cada transação com o byte de endereço
+#define DISPLAY_FRAME_BYTES  (40 + DISPLAY_PAGES * (DISPLAY_WIDTH + 6))
+// Transações por atualização: inicialização, janela e páginas (no SH1106
+// cada página tem a sua janela)
+#define DISPLAY_FRAME_TRANSFERS (2 + DISPLAY_PAGES * (DISPLAY_PAGE_ADDRESSING ? 2 : 1))
+// Um quadro na velocidade mínima, com a folga de cada transação, mais uma
+// recuperação do barramento após um estouro
+_Static_assert(DISPLAY_FRAME_BYTES * 9ull * 1000000u / DISPLAY_I2C_MIN_HZ +
+               DISPLAY_FRAME_TRANSFERS * I2C_BUS_SLACK_US + I2C_BUS_RECOVERY_US <= DISPLAY_MAX_BLOCK_US,
+               "Um quadro na velocidade minima do I2C nao cabe em DISPLAY_MAX_BLOCK_US");
+#else
+#error "DISPLAY_TRANSPORT desconhecido"
+#endif
+
+void ssd1306_init();
+void ssd1306_clear();
+void ssd1306_draw_pixel(int x, int y, bool color);
+// No SH1106 só existe endereçamento por página: set_page_address posiciona
+// a página start e set_column_address a coluna start (já com o deslocamento)
+void ssd1306_set_page_address(uint8_t start, uint8_t end);
+void ssd1306_set_column_address(uint8_t start, uint8_t end);
+// Envia o buffer, bloqueando no máximo DISPLAY_MAX_BLOCK_US no I2C. Devolve
+// false se o quadro não chegou inteiro (o barramento já foi recuperado e o
+// painel é reinicializado na próxima chamada).
+bool ssd1306_update();
+// Envio sem bloquear o laço: ssd1306_request_update() marca o buffer para
+// envio e ssd1306_service() manda as páginas pendentes cuja transação cabe,
+// no pior caso com a recuperação do barramento, até deadline (o próximo
+// tick). Após um erro o quadro recomeça da primeira página. Devolve true sem
+// nada pendente.
+void ssd1306_request_update(void);
+bool ssd1306_service(absolute_time_t deadline);
+void ssd1306_draw_char(int x, int y, char c);
+void ssd1306_draw_string(int x, int y, const char *str);
+void ssd1306_draw_hline(int x0, int x1, int y, bool color);
+void ssd1306_draw_vline(int x, int y0, int y1, bool color);
+
+#if DISPLAY_TRANSPORT == DISPLAY_I2C
+// Estatísticas do barramento do display
+const i2c_bus_t* ssd1306_bus(void);
+#endif
+
+#endif
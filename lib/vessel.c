@@ -0,0 +1,182 @@
+#include "vessel.h"
+#include "hot_path.h"
+#include <string.h>
+
+void vessels_init(vessels_t* v, const recipe_t* const* recipes, uint8_t count) {
+    memset(v, 0, sizeof(*v));
+    if (count > VESSEL_MAX) count = VESSEL_MAX;
+    v->count = count;
+    for (uint8_t i = 0; i < count; i++) {
+        v->recipe[i] = recipes[i];
+        v->stage[i] = VESSEL_IDLE;
+        v->sensor[i] = -1;
+        v->heat_rate[i] = VESSEL_HEAT_RATE_PRIOR;
+    }
+}
+
+void vessel_start(vessels_t* v, uint8_t i, uint8_t stage, uint32_t now_s) {
+    v->stage[i] = stage;
+    v->temperature[i] = v->recipe[i]->stages[stage].temp_min;
+    v->last_temperature[i] = v->temperature[i]; // Inicializa a temperatura anterior
+    v->timer_active[i] = false;
+    v->timer_finished[i] = false;
+    v->flame_active[i] = true;
+    v->first_max_reached[i] = false;
+    v->servo_angle[i] = 90;
+    v->preheating[i] = false;
+    v->rate_s[i] = now_s;
+    v->rate_t0[i] = v->temperature[i];
+    v->rate_heating[i] = false; // Primeira janela incompleta
+    if (v->total_time_start[i] == 0) v->total_time_start[i] = now_s;
+}
+
+void vessel_advance(vessels_t* v, uint8_t i, uint32_t now_s) {
+    if (v->stage[i] + 1 >= v->recipe[i]->num_stages) {
+        vessel_stop(v, i);
+        v->total_time_start[i] = 0;
+    } else if (v->mode[i] == VESSEL_MODE_MANUAL) {
+        vessel_start(v, i, v->stage[i] + 1, now_s);
+    } else {
+        // A panela já vem aquecendo para este estágio: mantém a temperatura
+        // e a saída calculada no tick (a válvula não salta para 90°)
+        float temperature = v->temperature[i];
+        float last_temperature = v->last_temperature[i];
+        uint8_t servo_angle = v->servo_angle[i];
+        uint16_t led_intensity = v->led_intensity[i];
+        bool flame_active = v->flame_active[i];
+        vessel_start(v, i, v->stage[i] + 1, now_s);
+        v->temperature[i] = temperature;
+        v->last_temperature[i] = last_temperature;
+        v->rate_t0[i] = temperature;
+        v->servo_angle[i] = servo_angle;
+        v->led_intensity[i] = led_intensity;
+        v->flame_active[i] = flame_active;
+    }
+}
+
+void vessel_stop(vessels_t* v, uint8_t i) {
+    v->stage[i] = VESSEL_IDLE;
+    v->flame_active[i] = false;
+    v->timer_active[i] = false;
+    v->timer_finished[i] = false;
+    v->first_max_reached[i] = false;
+    v->servo_angle[i] = 0;
+    v->led_intensity[i] = 0;
+    v->preheating[i] = false;
+}
+
+void vessel_reset(vessels_t* v, uint8_t i) {
+    vessel_stop(v, i);
+    v->temperature[i] = 0.0f;
+    v->last_temperature[i] = 0.0f; // Reseta a temperatura anterior
+    v->timer_start[i] = 0;
+    v->total_time_start[i] = 0;
+    v->heat_rate[i] = VESSEL_HEAT_RATE_PRIOR;
+}
+
+// Fecha a janela de 1 s: se a válvula ficou aberta o tempo todo, a subida
+// observada entra na média móvel da taxa de aquecimento
+static void HOT_PATH(estimate_heat_rate)(vessels_t* v, uint8_t i, uint32_t now_s) {
+    if (now_s != v->rate_s[i]) {
+        if (v->rate_heating[i] && now_s - v->rate_s[i] == 1) {
+            float rise = v->temperature[i] - v->rate_t0[i];
+            if (rise < 0.0f) rise = 0.0f;
+            v->heat_rate[i] += VESSEL_RATE_ALPHA * (rise - v->heat_rate[i]);
+        }
+        v->rate_s[i] = now_s;
+        v->rate_t0[i] = v->temperature[i];
+        v->rate_heating[i] = true;
+    }
+    if (v->servo_angle[i] == 0) v->rate_heating[i] = false;
+}
+
+static inline float ramp_time(const vessels_t* v, uint8_t i, float from, float to) {
+    float rate = v->heat_rate[i] > VESSEL_RATE_MIN ? v->heat_rate[i] : VESSEL_RATE_MIN;
+    return to > from ? (to - from) / rate : 0.0f;
+}
+
+uint32_t vessel_remaining_time(const vessels_t* v, uint8_t i, uint32_t now_s) {
+    if (!vessel_running(v, i)) return 0;
+    const recipe_t* r = v->recipe[i];
+    const brassagem_stage_t* stage = vessel_current_stage(v, i);
+    bool predictive = v->mode[i] != VESSEL_MODE_MANUAL;
+
+    // Estágio atual: o que falta do patamar, ou a subida até ele e o patamar inteiro
+    float hold;
+    float remaining = 0.0f;
+    if (v->timer_active[i]) {
+        uint32_t elapsed = now_s - v->timer_start[i];
+        hold = elapsed < stage->duration ? (float)(stage->duration - elapsed) : 0.0f;
+    } else {
+        remaining = ramp_time(v, i, v->temperature[i], stage->temp_max);
+        hold = (float)stage->duration;
+    }
+    remaining += hold;
+
+    // Estágios seguintes: no modo preditivo a subida se sobrepõe ao patamar anterior
+    float from = v->temperature[i] > stage->temp_max ? v->temperature[i] : stage->temp_max;
+    for (uint8_t s = v->stage[i] + 1; s < r->num_stages; s++) {
+        const brassagem_stage_t* next = &r->stages[s];
+        float ramp = ramp_time(v, i, from, next->temp_max);
+        if (predictive) ramp = ramp > hold ? ramp - hold : 0.0f;
+        remaining += ramp + (float)next->duration;
+        hold = (float)next->duration;
+        from = next->temp_max > from ? next->temp_max : from;
+    }
+    return (uint32_t)(remaining + 0.5f);
+}
+
+void HOT_PATH(vessels_tick)(vessels_t* v, const int16_t* input, uint32_t now_s) {
+    for (uint8_t i = 0; i < v->count; i++) {
+        if (!vessel_running(v, i)) {
+            v->servo_angle[i] = 0;
+            v->led_intensity[i] = 0;
+            continue;
+        }
+
+        const brassagem_stage_t* stage = vessel_current_stage(v, i);
+        // Pré-aquecendo: o controle já segue a janela do próximo estágio
+        const brassagem_stage_t* target = v->preheating[i] ? stage + 1 : stage;
+        if (v->sensor[i] < 0) {
+            v->servo_angle[i] = control_step(&v->temperature[i], &v->last_temperature[i],
+                                             &v->flame_active[i], target, input[i],
+                                             &v->led_intensity[i]);
+        } else if (v->measured_ok[i]) {
+            v->servo_angle[i] = control_step_measured(v->measured[i], &v->temperature[i],
+                                                      &v->last_temperature[i], &v->flame_active[i],
+                                                      target, &v->led_intensity[i]);
+        } else {
+            // Sem leitura recente: não aquece às cegas
+            v->flame_active[i] = false;
+            v->servo_angle[i] = 0;
+            v->led_intensity[i] = 0;
+            v->rate_heating[i] = false;
+            continue;
+        }
+        estimate_heat_rate(v, i, now_s);
+
+        if (!v->first_max_reached[i] && v->temperature[i] >= stage->temp_max) {
+            v->timer_start[i] = now_s;
+            v->timer_active[i] = true;
+            v->first_max_reached[i] = true;
+        }
+
+        if (v->timer_active[i] && (now_s - v->timer_start[i]) >= stage->duration) {
+            v->timer_finished[i] = true;
+        }
+
+        if (v->mode[i] == VESSEL_MODE_MANUAL || v->stage[i] + 1 >= v->recipe[i]->num_stages) continue;
+
+        // Começa a subir quando o patamar restante for menor que a subida prevista
+        if (v->timer_active[i] && !v->preheating[i]) {
+            uint32_t elapsed = now_s - v->timer_start[i];
+            float hold = elapsed < stage->duration ? (float)(stage->duration - elapsed) : 0.0f;
+            if (hold <= ramp_time(v, i, v->temperature[i], stage[1].temp_max)) {
+                v->preheating[i] = true;
+                v->flame_active[i] = true;
+            }
+        }
+
+        if (v->timer_finished[i] && v->mode[i] == VESSEL_MODE_AUTO) vessel_advance(v, i, now_s);
+    }
+}
@@ -0,0 +1,110 @@
+#ifndef VESSEL_H
+#define VESSEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "control.h"
+
+#define VESSEL_MAX  4     // Capacidade máxima de panelas (HLT, mostura, fervura, ...)
+#define VESSEL_IDLE 0xFF  // Panela parada no menu de seleção
+
+#ifndef VESSEL_COUNT
+#define VESSEL_COUNT 3    // Panelas ativas no firmware: mostura, HLT e fervura
+#endif
+_Static_assert(VESSEL_COUNT >= 1 && VESSEL_COUNT <= VESSEL_MAX, "VESSEL_COUNT fora do intervalo");
+
+// Transição entre estágios
+#define VESSEL_MODE_MANUAL  0  // Espera o botão A e só então aquece para o próximo estágio
+#define VESSEL_MODE_PREHEAT 1  // Começa a aquecer para o próximo estágio antes do fim do atual
+#define VESSEL_MODE_AUTO    2  // Pré-aquecimento e avanço automático
+#define VESSEL_MODES        3
+
+#define VESSEL_HEAT_RATE_PRIOR 0.5f  // °C/s antes da primeira estimativa
+#define VESSEL_RATE_ALPHA      0.2f  // Peso de cada nova janela de 1 s na média móvel
+#define VESSEL_RATE_MIN        0.01f // Piso da taxa nas previsões
+
+// Receita de uma panela: sequência de estágios executados em ordem
+typedef struct {
+    const char* nome;
+    const brassagem_stage_t* stages;
+    uint8_t num_stages;
+} recipe_t;
+
+// Estado de todas as panelas em layout struct-of-arrays: o tick percorre
+// cada campo de forma contígua e o custo por panela fica constante.
+typedef struct {
+    uint8_t count;
+    const recipe_t* recipe[VESSEL_MAX];
+    uint8_t stage[VESSEL_MAX];              // Índice na receita ou VESSEL_IDLE
+    float temperature[VESSEL_MAX];
+    float last_temperature[VESSEL_MAX];     // Temperatura do ciclo anterior
+    uint32_t timer_start[VESSEL_MAX];       // Para o temporizador de estágio
+    uint32_t total_time_start[VESSEL_MAX];  // Para o temporizador total
+    bool flame_active[VESSEL_MAX];
+    bool timer_active[VESSEL_MAX];
+    bool timer_finished[VESSEL_MAX];
+    bool first_max_reached[VESSEL_MAX];
+    int8_t sensor[VESSEL_MAX];              // Canal da sonda ou -1 (simulada pelo joystick)
+    float measured[VESSEL_MAX];             // Entrada: última leitura da sonda
+    bool measured_ok[VESSEL_MAX];           // Entrada: leitura presente e recente
+    uint8_t servo_angle[VESSEL_MAX];        // Saída: ângulo da válvula
+    uint16_t led_intensity[VESSEL_MAX];     // Saída: intensidade 0..4095
+
+    // Transição preditiva: taxa de aquecimento estimada em janelas de 1 s
+    // com a válvula aberta, usada para antecipar o próximo estágio
+    uint8_t mode[VESSEL_MAX];               // VESSEL_MODE_*
+    bool preheating[VESSEL_MAX];            // Já controlando pela janela do próximo estágio
+    float heat_rate[VESSEL_MAX];            // °C/s observados com a válvula aberta
+    float rate_t0[VESSEL_MAX];              // Temperatura no início da janela
+    uint32_t rate_s[VESSEL_MAX];            // Segundo em que a janela começou
+    bool rate_heating[VESSEL_MAX];          // Válvula aberta durante toda a janela
+} vessels_t;
+
+void vessels_init(vessels_t* v, const recipe_t* const* recipes, uint8_t count);
+
+// Inicia a panela no estágio indicado (botão B no menu)
+void vessel_start(vessels_t* v, uint8_t i, uint8_t stage, uint32_t now_s);
+// Avança para o próximo estágio, ou volta ao menu após o último (botão A)
+void vessel_advance(vessels_t* v, uint8_t i, uint32_t now_s);
+// Volta ao menu mantendo temperatura e tempo total (botão B em execução)
+void vessel_stop(vessels_t* v, uint8_t i);
+// Volta ao menu e zera temperatura e temporizadores (botão do joystick)
+void vessel_reset(vessels_t* v, uint8_t i);
+
+// Um passo de controle para todas as panelas. input[i] é o desvio do
+// joystick aplicado à panela i (0 para as que não estão em foco); panelas
+// com sonda usam measured[i] e fecham a válvula se a leitura faltar.
+// Fora do modo manual, quando o tempo restante do estágio cai abaixo do
+// tempo previsto para chegar ao próximo, o controle passa a seguir a
+// janela do próximo estágio; no modo automático o avanço também é feito
+// aqui, assim que o temporizador termina.
+void vessels_tick(vessels_t* v, const int16_t* input, uint32_t now_s);
+
+// Tempo previsto (s) até o fim do último estágio da receita, com a taxa de
+// aquecimento estimada. No modo manual não conta a espera pelo botão A.
+uint32_t vessel_remaining_time(const vessels_t* v, uint8_t i, uint32_t now_s);
+
+static inline bool vessel_running(const vessels_t* v, uint8_t i) {
+    return v->stage[i] != VESSEL_IDLE;
+}
+
+static inline bool vessels_any_running(const vessels_t* v) {
+    for (uint8_t i = 0; i < v->count; i++) {
+        if (vessel_running(v, i)) return true;
+    }
+    return false;
+}
+
+static inline const brassagem_stage_t* vessel_current_stage(const vessels_t* v, uint8_t i) {
+    return &v->recipe[i]->stages[v->stage[i]];
+}
+
+static inline uint32_t vessel_stage_time(const vessels_t* v, uint8_t i, uint32_t now_s) {
+    return v->timer_active[i] ? (now_s - v->timer_start[i]) : 0;
+}
+
+static inline uint32_t vessel_total_time(const vessels_t* v, uint8_t i, uint32_t now_s) {
+    return (vessel_running(v, i) && v->total_time_start[i] != 0) ? (now_s - v->total_time_start[i]) : 0;
+}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef ZERO_HEAP_H
+#define ZERO_HEAP_H
+
+// Incluído à força (-include) em todas as fontes do firmware no perfil
+// U7T_ZERO_HEAP: qualquer uso de malloc/free passa a ser erro de compilação.
+// Os cabeçalhos que declaram o alocador são incluídos antes do poison.
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#pragma GCC poison malloc calloc realloc free
+
+#endif
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+"""Exporta e decodifica uma corrida gravada por lib/brewlog.c.
+
+Pede a corrida pela serial USB (comando "e <n>") ou lê um dump bruto já
+salvo e imprime as amostras em CSV:
+
+    tempo_s,panela,temp_c,setpoint_c,valvula,estagio,chama,timer,fim,sonda
+
+uso: brewlog_dump.py --port /dev/ttyACM0 --run 3 [--raw run3.bin] > run3.csv
+     brewlog_dump.py --file run3.bin > run3.csv
+"""
+
+import argparse
+import struct
+import sys
+
+SECTOR_SIZE = 4096
+MAGIC = 0x474F4C42
+VERSION = 1
+TIME_UNIT_S = 0.010
+HEADER = struct.Struct("<IIHHHBB")
+
+F_TEMP, F_SETPOINT, F_ANGLE, F_STATE = 0x01, 0x02, 0x04, 0x08
+TAG_END, TAG_LOST = 0x80, 0x81
+S_STAGE, S_FLAME, S_TIMER, S_FINISHED, S_SENSOR = 0x07, 0x08, 0x10, 0x20, 0x40
+
+
+def varint(buf, pos):
+    value = shift = 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if not b & 0x80:
+            return value, pos
+
+
+def unzigzag(z):
+    return (z >> 1) ^ -(z & 1)
+
+
+def decode_sector(data, out):
+    magic, serial, run, index, period_ms, vessels, version = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        return
+    if index == 0:
+        out.write(f"# corrida {run}: {vessels} panelas, periodo {period_ms} ms\n")
+
+    # Base dos deltas zerada a cada setor
+    t = 0
+    temp = [0] * 4
+    setpoint = [0] * 4
+    angle = [0] * 4
+    state = [0] * 4
+    pos = HEADER.size
+    while pos < len(data) and data[pos] != 0xFF:
+        tag = data[pos]
+        pos += 1
+        if tag == TAG_END:
+            dt, pos = varint(data, pos)
+            out.write(f"# fim da corrida em {(t + dt) * TIME_UNIT_S:.2f} s\n")
+            continue
+        if tag == TAG_LOST:
+            lost, pos = varint(data, pos)
+            out.write(f"# {lost} registros perdidos\n")
+            continue
+        vessel, fields = tag & 0x03, tag >> 2
+        # Energia cortada entre as duas páginas de um registro: o resto dele
+        # ficou apagado (0xFF), e nenhum campo completo termina assim
+        try:
+            dt, pos = varint(data, pos)
+            if fields & F_TEMP:
+                dtemp, pos = varint(data, pos)
+            if fields & F_SETPOINT:
+                dsetpoint, pos = varint(data, pos)
+            if fields & F_ANGLE:
+                dangle, pos = varint(data, pos)
+            if fields & F_STATE:
+                if data[pos] & 0x80:
+                    raise IndexError
+                state[vessel] = data[pos]
+                pos += 1
+        except IndexError:
+            out.write("# registro incompleto no fim do setor (energia cortada)\n")
+            return
+        t += dt
+        if fields & F_TEMP:
+            temp[vessel] += unzigzag(dtemp)
+        if fields & F_SETPOINT:
+            setpoint[vessel] += unzigzag(dsetpoint)
+        if fields & F_ANGLE:
+            angle[vessel] += unzigzag(dangle)
+        s = state[vessel]
+        stage = "" if (s & S_STAGE) == S_STAGE else s & S_STAGE
+        out.write(f"{t * TIME_UNIT_S:.2f},{vessel},{temp[vessel] / 16:.2f},{setpoint[vessel] / 16:.2f},"
+                  f"{angle[vessel]},{stage},{int(bool(s & S_FLAME))},{int(bool(s & S_TIMER))},"
+                  f"{int(bool(s & S_FINISHED))},{int(bool(s & S_SENSOR))}\n")
+
+
+def fetch(port, run):
+    import serial  # pyserial
+
+    with serial.Serial(port, timeout=5) as ser:
+        ser.reset_input_buffer()
+        ser.write(f"e {run}\n".encode())
+        while True:
+            line = ser.readline().decode(errors="replace").strip()
+            if not line:
+                sys.exit("sem resposta do firmware")
+            if line.startswith("BREWLOG "):
+                break
+            if "nao encontrada" in line:
+                sys.exit(line)
+        size = int(dict(f.split("=") for f in line.split()[1:])["bytes"])
+        data = ser.read(size)
+        if len(data) != size:
+            sys.exit(f"exportacao incompleta: {len(data)} de {size} bytes")
+        return data
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--port")
+    ap.add_argument("--run", type=int)
+    ap.add_argument("--raw", help="salva o dump bruto recebido")
+    ap.add_argument("--file", help="decodifica um dump bruto salvo")
+    args = ap.parse_args()
+
+    if args.file:
+        with open(args.file, "rb") as f:
+            data = f.read()
+    elif args.port and args.run is not None:
+        data = fetch(args.port, args.run)
+        if args.raw:
+            with open(args.raw, "wb") as f:
+                f.write(data)
+    else:
+        ap.error("use --file ou --port com --run")
+
+    sys.stdout.write("tempo_s,panela,temp_c,setpoint_c,valvula,estagio,chama,timer,fim,sonda\n")
+    for off in range(0, len(data) - SECTOR_SIZE + 1, SECTOR_SIZE):
+        decode_sector(data[off:off + SECTOR_SIZE], sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Relatório de orçamento de memória por módulo a partir do mapa do linker.
+
+Soma flash, RAM e o maior quadro de pilha (-fstack-usage) de cada módulo do
+firmware, compara com tools/memory_budget.txt e retorna 1 se algum limite
+for excedido. Com --no-heap também falha se o malloc tiver sido ligado.
+
+uso: mem_budget.py --map U7T_projeto.elf.map --objdir CMakeFiles/U7T_projeto.dir
+                   --budget tools/memory_budget.txt [--no-heap] fonte.c ...
+"""
+
+import argparse
+import os
+import re
+import sys
+from collections import defaultdict
+
+HEAP_SECTION = re.compile(r"\.text\.(__wrap_)?_?(malloc|calloc|realloc|free)(_r)?$")
+OUT_SECTION = re.compile(r"^(\.\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?")
+OUT_SECTION_NAME = re.compile(r"^(\.\S+)\s*$")
+IN_SECTION = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+IN_SECTION_NAME = re.compile(r"^ (\S+)\s*$")
+IN_SECTION_CONT = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+REGION = re.compile(r"^(\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)")
+
+
+def module_of(obj, sources):
+    for src in sources:
+        if obj.endswith("/" + src + ".obj") or obj.endswith("/" + src + ".o"):
+            return src
+    m = re.search(r"([^/\\]+\.a)\(", obj)
+    if m:
+        return m.group(1)
+    return "pico-sdk"
+
+
+def parse_map(path, sources):
+    regions = []
+    flash = defaultdict(int)
+    ram = defaultdict(int)
+    heap = []
+    in_map = False
+    out_name, out_load = None, False
+    pending_out, pending_in = None, None
+
+    def region_kind(addr):
+        for name, origin, length in regions:
+            if origin <= addr < origin + length:
+                return "flash" if "FLASH" in name.upper() else "ram"
+        return None
+
+    def account(section, addr, size, obj):
+        if size == 0 or section.startswith("*"):
+            return
+        mod = module_of(obj, sources)
+        kind = region_kind(addr)
+        if kind is None:  # Mapa sem regiões (ex.: build nativo): usa o nome
+            kind = "ram" if out_name in (".data", ".bss", ".tdata", ".tbss") else "flash"
+        if kind == "ram":
+            ram[mod] += size
+            if out_load:
+                flash[mod] += size  # Valor inicial copiado da flash no boot
+        else:
+            flash[mod] += size
+        if HEAP_SECTION.search(section) or "mallocr" in obj or "pico_malloc" in obj:
+            heap.append("%s (%s)" % (section, obj))
+
+    with open(path, errors="replace") as f:
+        for line in f:
+            line = line.rstrip("\n")
+            if not in_map:
+                if line.startswith("Linker script and memory map"):
+                    in_map = True
+                    continue
+                m = REGION.match(line)
+                if m and m.group(1) != "*default*" and m.group(1) != "Name":
+                    regions.append((m.group(1), int(m.group(2), 16), int(m.group(3), 16)))
+                continue
+
+            if pending_out:
+                m = re.match(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)(?:\s+load address 0x([0-9a-fA-F]+))?", line)
+                out_name, out_load = pending_out, bool(m and m.group(3))
+                pending_out = None
+                continue
+            if pending_in:
+                m = IN_SECTION_CONT.match(line)
+                if m:
+                    account(pending_in, int(m.group(1), 16), int(m.group(2), 16), m.group(3))
+                pending_in = None
+                continue
+
+            m = OUT_SECTION.match(line)
+            if m:
+                out_name, out_load = m.group(1), bool(m.group(4))
+                continue
+            m = OUT_SECTION_NAME.match(line)
+            if m:
+                pending_out = m.group(1)
+                continue
+            m = IN_SECTION.match(line)
+            if m:
+                account(m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4))
+                continue
+            m = IN_SECTION_NAME.match(line)
+            if m and not m.group(1).startswith("*"):
+                pending_in = m.group(1)
+    return flash, ram, heap
+
+
+def parse_stack(objdir, sources):
+    stack = defaultdict(int)
+    worst = {}
+    for root, _, files in os.walk(objdir):
+        for name in files:
+            if not name.endswith(".su"):
+                continue
+            path = os.path.join(root, name)
+            mod = module_of(path[:-3] + ".obj", sources)
+            with open(path, errors="replace") as f:
+                for line in f:
+                    parts = line.rstrip("\n").split("\t")
+                    if len(parts) < 2 or not parts[1].isdigit():
+                        continue
+                    size = int(parts[1])
+                    if size > stack[mod]:
+                        stack[mod] = size
+                        worst[mod] = parts[0].split(":")[-1]
+    return stack, worst
+
+
+def parse_budget(path):
+    budget = {}
+    with open(path) as f:
+        for line in f:
+            line = line.split("#", 1)[0].strip()
+            if not line:
+                continue
+            name, *limits = line.split()
+            budget[name] = [None if v == "-" else int(v, 0) for v in limits[:3]]
+    return budget
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--map", required=True)
+    ap.add_argument("--objdir", required=True)
+    ap.add_argument("--budget", required=True)
+    ap.add_argument("--no-heap", action="store_true")
+    ap.add_argument("sources", nargs="*")
+    args = ap.parse_args()
+
+    flash, ram, heap = parse_map(args.map, args.sources)
+    stack, worst = parse_stack(args.objdir, args.sources)
+    budget = parse_budget(args.budget)
+
+    modules = sorted(set(flash) | set(ram) | set(stack),
+                     key=lambda m: (m not in args.sources, m))
+    total = ["TOTAL", sum(flash.values()), sum(ram.values()), max(stack.values(), default=0)]
+    failures = []
+
+    def cell(value, limit):
+        return "%7d" % value if limit is None else "%7d/%-7d" % (value, limit)
+
+    print("Orcamento de memoria (%s)" % os.path.basename(args.map))
+    print("%-22s %15s %15s %15s" % ("modulo", "flash", "RAM", "maior quadro"))
+    for mod, f, r, s in [(m, flash[m], ram[m], stack[m]) for m in modules] + [total]:
+        limits = budget.get(mod, [None, None, None])
+        over = [label for label, value, limit in zip(("flash", "RAM", "pilha"), (f, r, s), limits)
+                if limit is not None and value > limit]
+        note = "  EXCEDIDO: " + ", ".join(over) if over else ""
+        if mod in worst and s:
+            note += "  (%s)" % worst[mod]
+        print("%-22s %15s %15s %15s%s" % (mod, cell(f, limits[0]), cell(r, limits[1]), cell(s, limits[2]), note))
+        failures += ["%s: %s" % (mod, o) for o in over]
+
+    if args.no_heap and heap:
+        print("Perfil sem heap, mas o alocador foi ligado:")
+        for h in sorted(set(heap)):
+            print("  " + h)
+        failures.append("heap")
+
+    if failures:
+        print("Orcamento de memoria excedido: " + "; ".join(failures))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())